@@ -0,0 +1,55 @@
+"""
+Compares the two ways `parse` can split a file between threads: by rows (split="rows") and by
+fields (split="columns"), on a narrow schema and on a wide one.
+
+    $ python3 benchmark.py [nlines] [threads...]
+"""
+from lineparser import parse, Field, Ty
+import numpy as np
+import os
+import sys
+import tempfile
+import time
+
+def make_file(path, fields, nlines):
+    rng = np.random.RandomState(0)
+    columns = []
+    for field in fields:
+        if field.ty == Ty.Float64:
+            values = rng.uniform(-1000, 1000, nlines)
+            columns.append([f"{v:{field.len}.4f}".encode() for v in values])
+        else:
+            values = rng.randint(-9999, 9999, nlines)
+            columns.append([f"{v:{field.len}d}".encode() for v in values])
+    with open(path, "wb") as file:
+        for row in zip(*columns):
+            file.write(b"".join(row) + b"\n")
+
+def best_of(n, f):
+    best = float("inf")
+    for _ in range(n):
+        start = time.time()
+        f()
+        best = min(best, time.time() - start)
+    return best
+
+nlines = int(sys.argv[1]) if len(sys.argv) > 1 else 200000
+thread_counts = [int(t) for t in sys.argv[2:]] or [1, 2, 4, 8]
+
+schemas = {
+    "narrow (8 fields)": [Field(float, 12), Field(float, 10), Field(float, 12), Field(int, 6),
+                          Field(int, 6), Field(float, 14), Field(float, 14), Field(int, 6)],
+    "wide (300 fields)": [Field(float, 12) if i % 3 else Field(int, 8) for i in range(300)],
+}
+
+with tempfile.TemporaryDirectory() as tmp:
+    for name, fields in schemas.items():
+        path = os.path.join(tmp, "bench.lines")
+        # Keep the wide file at a similar size to the narrow one
+        n = nlines if len(fields) < 100 else max(nlines // 30, 1)
+        make_file(path, fields, n)
+        print(f"{name}: {n} lines, {os.path.getsize(path) / 1e6:.1f} MB")
+        for threads in thread_counts:
+            rows = best_of(3, lambda: parse(fields, path, threads=threads, split="rows"))
+            cols = best_of(3, lambda: parse(fields, path, threads=threads, split="columns"))
+            print(f"    threads={threads:<3} rows: {rows:.3f}s  columns: {cols:.3f}s")
@@ -1,25 +1,26 @@
+import sys
 from setuptools import setup
 from setuptools.extension import Extension
+# The extension is always built from the .pyx; no generated C is shipped, since it would go stale
+from Cython.Build import cythonize
 
-def should_use_cython():
-    try:
-        import Cython
-        return True
-    except:
-        return False
+# Multi-threaded parsing uses OpenMP through Cython's prange. Without it (e.g. Apple's clang) the
+# extension still builds, but every parse runs on one thread.
+if sys.platform == 'win32':
+    openmp_args = ['/openmp']
+elif sys.platform == 'darwin':
+    openmp_args = []
+else:
+    openmp_args = ['-fopenmp']
 
-USE_CYTHON = should_use_cython()
+extensions = [Extension("lineparser", ["src/lineparser.pyx"],
+                        extra_compile_args=openmp_args,
+                        extra_link_args=openmp_args if sys.platform != 'win32' else [])]
 
-ext = '.pyx' if USE_CYTHON else '.c'
+extensions = cythonize(extensions)
 
-extensions = [Extension("lineparser", ["src/lineparser" + ext])]
-
-if USE_CYTHON:
-    from Cython.Build import cythonize
-    extensions = cythonize(extensions)
-    
-    for e in extensions:
-        e.cython_directives = {"embedsignature": True}
+for e in extensions:
+    e.cython_directives = {"embedsignature": True}
 
 with open("README.md", "r") as f:
     long_description = f.read()
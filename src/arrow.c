@@ -0,0 +1,176 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * The Arrow C data interface (https://arrow.apache.org/docs/format/CDataInterface.html) and the
+ * helpers parse(..., result="arrow") uses to lay columns out the way Arrow expects. The structs
+ * are copied verbatim from the specification, which is how it is meant to be used: there is
+ * nothing to link against.
+ */
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    // Array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+#ifndef ARROW_C_STREAM_INTERFACE
+#define ARROW_C_STREAM_INTERFACE
+
+struct ArrowArrayStream {
+    // Callbacks providing stream functionality
+    int (*get_schema)(struct ArrowArrayStream*, struct ArrowSchema* out);
+    int (*get_next)(struct ArrowArrayStream*, struct ArrowArray* out);
+    const char* (*get_last_error)(struct ArrowArrayStream*);
+
+    // Release callback
+    void (*release)(struct ArrowArrayStream*);
+
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+#endif  // ARROW_C_STREAM_INTERFACE
+
+/*
+ * Offsets for n fixed-width strings of `width` bytes stored back to back, i.e. offsets[i] =
+ * i * width for i in [0, n]. The 32 bit version is for the "u" / "z" formats and the 64 bit one
+ * for "U" / "Z", which are needed once the data is 2 GiB or more.
+ */
+static void fixed_width_offsets32(int32_t *offsets, int64_t n, int width) {
+    int32_t offset = 0;
+    for (int64_t i = 0; i <= n; i++, offset += width)
+        offsets[i] = offset;
+}
+
+static void fixed_width_offsets64(int64_t *offsets, int64_t n, int width) {
+    int64_t offset = 0;
+    for (int64_t i = 0; i <= n; i++, offset += width)
+        offsets[i] = offset;
+}
+
+/*
+ * Turns a mask array (1 byte per row, non-zero for nulls) into an Arrow validity bitmap (1 bit
+ * per row, set for valid rows, least significant bit first). bitmap must have (n + 7) / 8 bytes.
+ * Returns the number of nulls.
+ */
+static int64_t mask_to_validity(const uint8_t *mask, uint8_t *bitmap, int64_t n) {
+    int64_t nulls = 0;
+    memset(bitmap, 0, (size_t) ((n + 7) / 8));
+    for (int64_t i = 0; i < n; i++) {
+        if (mask[i])
+            nulls++;
+        else
+            bitmap[i >> 3] |= (uint8_t) (1 << (i & 7));
+    }
+    return nulls;
+}
+
+/*
+ * Checks n fixed-width strings of `width` bytes stored back to back for invalid UTF-8 (which
+ * Arrow's string types don't allow), with the same rules as parse_ucs4. Returns the index of the
+ * first invalid one, or -1 if they are all valid.
+ */
+static int64_t first_invalid_utf8(const char *data, int64_t n, int width) {
+    static const uint32_t utf8_min[4] = {0, 0x80, 0x800, 0x10000};
+    for (int64_t i = 0; i < n; i++) {
+        const unsigned char *p = (const unsigned char *) data + i * width, *end = p + width;
+        while (p < end) {
+            uint32_t c = *p++;
+            if (c < 0x80)
+                continue;
+            int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0, k = extra;
+            if (extra == 0 || c >= 0xF8 || end - p < extra)
+                return i;
+            c &= 0x3F >> extra;
+            while (k--) {
+                if ((*p & 0xC0) != 0x80)
+                    return i;
+                c = (c << 6) | (*p++ & 0x3F);
+            }
+            // Overlong encodings (using more bytes than the code point needs) are invalid too
+            if (c < utf8_min[extra] || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF))
+                return i;
+        }
+    }
+    return -1;
+}
+
+// The length of a fixed-width string of `width` bytes without its trailing zero bytes.
+static inline int unpadded_len(const char *str, int width) {
+    while (width > 0 && str[width - 1] == 0)
+        width--;
+    return width;
+}
+
+// The total length of n fixed-width strings of `width` bytes without their trailing zero bytes.
+static int64_t unpadded_size(const char *data, int64_t n, int width) {
+    int64_t size = 0;
+    for (int64_t i = 0; i < n; i++)
+        size += unpadded_len(data + i * width, width);
+    return size;
+}
+
+/*
+ * Copies n fixed-width strings of `width` bytes to dst back to back without their trailing zero
+ * bytes (the padding of stripped fields), and writes their offsets like fixed_width_offsets32 /
+ * fixed_width_offsets64. dst must have room for unpadded_size bytes.
+ */
+static void unpad_strings32(const char *data, int64_t n, int width, char *dst, int32_t *offsets) {
+    int32_t offset = 0;
+    for (int64_t i = 0; i < n; i++) {
+        int len = unpadded_len(data + i * width, width);
+        offsets[i] = offset;
+        memcpy(dst + offset, data + i * width, len);
+        offset += len;
+    }
+    offsets[n] = offset;
+}
+
+static void unpad_strings64(const char *data, int64_t n, int width, char *dst, int64_t *offsets) {
+    int64_t offset = 0;
+    for (int64_t i = 0; i < n; i++) {
+        int len = unpadded_len(data + i * width, width);
+        offsets[i] = offset;
+        memcpy(dst + offset, data + i * width, len);
+        offset += len;
+    }
+    offsets[n] = offset;
+}
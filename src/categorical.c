@@ -0,0 +1,161 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Dictionary encoding for Categorical fields. Each distinct value of a field (its raw bytes) gets
+ * the next int32 code the first time it is seen; the codes are found through an open addressing
+ * hash table with linear probing that is kept at most half full.
+ */
+
+typedef struct {
+    // The output: one code per row
+    int32_t *codes;
+    int width;
+    // The distinct values, `width` bytes each, in order of their codes
+    char *values;
+    int64_t n_unique;
+    int64_t values_cap;
+    // Hash table slots holding code + 1, or 0 if empty; the number of slots is a power of two
+    int32_t *slots;
+    int64_t n_slots;
+    // Set if the table couldn't grow; the codes are then incomplete
+    int failed;
+    // Scratch space for parse_categorical_span
+    char *key;
+} CatTable;
+
+#define CAT_INITIAL_SLOTS 256
+
+static inline uint64_t cat_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Hashes a field 8 bytes at a time.
+static inline uint64_t cat_hash(const char *str, int len) {
+    uint64_t h = (uint64_t) len * 0x9E3779B97F4A7C15ULL, word;
+    while (len >= 8) {
+        memcpy(&word, str, 8);
+        h = (h ^ word) * 0x9E3779B97F4A7C15ULL;
+        str += 8;
+        len -= 8;
+    }
+    if (len > 0) {
+        word = 0;
+        memcpy(&word, str, len);
+        h = (h ^ word) * 0x9E3779B97F4A7C15ULL;
+    }
+    return cat_mix(h);
+}
+
+static void cat_free(CatTable *t) {
+    free(t->values);
+    free(t->slots);
+    free(t->key);
+    t->values = NULL;
+    t->slots = NULL;
+    t->key = NULL;
+}
+
+// Sets up an empty table writing codes to `codes`. Returns 0 on success.
+static int cat_init(CatTable *t, int32_t *codes, int width) {
+    t->codes = codes;
+    t->width = width;
+    t->n_unique = 0;
+    t->values_cap = 16;
+    t->n_slots = CAT_INITIAL_SLOTS;
+    t->failed = 0;
+    t->values = (char *) malloc((size_t) t->values_cap * width);
+    t->slots = (int32_t *) calloc((size_t) t->n_slots, sizeof(int32_t));
+    t->key = (char *) malloc((size_t) width);
+    if (t->values == NULL || t->slots == NULL || t->key == NULL) {
+        cat_free(t);
+        t->failed = 1;
+        return 1;
+    }
+    return 0;
+}
+
+// Empties the table for another parse, keeping the memory it has grown to.
+static void cat_reset(CatTable *t) {
+    t->n_unique = 0;
+    t->failed = 0;
+    memset(t->slots, 0, (size_t) t->n_slots * sizeof(int32_t));
+}
+
+// Doubles the number of slots and re-inserts every value.
+static int cat_grow(CatTable *t) {
+    int64_t n_slots = t->n_slots * 2;
+    int32_t *slots = (int32_t *) calloc((size_t) n_slots, sizeof(int32_t));
+    if (slots == NULL)
+        return 1;
+    for (int64_t code = 0; code < t->n_unique; code++) {
+        uint64_t i = cat_hash(t->values + code * t->width, t->width) & (n_slots - 1);
+        while (slots[i] != 0)
+            i = (i + 1) & (n_slots - 1);
+        slots[i] = (int32_t) (code + 1);
+    }
+    free(t->slots);
+    t->slots = slots;
+    t->n_slots = n_slots;
+    return 0;
+}
+
+/*
+ * Writes the code of the field at `str` to row line_n of the table's codes (`output` is the
+ * CatTable), adding it to the table if it is new. Returns 0 on success, or 1 if the table is out
+ * of memory or codes, in which case `failed` is set too.
+ */
+static inline int parse_categorical(void *output, const char *str, int64_t line_n, int field_len) {
+    CatTable *t = (CatTable *) output;
+    if (t->failed)
+        return 1;
+
+    uint64_t i = cat_hash(str, field_len) & (t->n_slots - 1);
+    int32_t slot;
+    while ((slot = t->slots[i]) != 0) {
+        if (memcmp(t->values + (int64_t) (slot - 1) * field_len, str, field_len) == 0) {
+            t->codes[line_n] = slot - 1;
+            return 0;
+        }
+        i = (i + 1) & (t->n_slots - 1);
+    }
+
+    if (t->n_unique == INT32_MAX) {
+        t->failed = 1;
+        return 1;
+    }
+    if (t->n_unique == t->values_cap) {
+        char *values = (char *) realloc(t->values, (size_t) t->values_cap * 2 * field_len);
+        if (values == NULL) {
+            t->failed = 1;
+            return 1;
+        }
+        t->values = values;
+        t->values_cap *= 2;
+    }
+    memcpy(t->values + t->n_unique * field_len, str, field_len);
+    t->slots[i] = (int32_t) (t->n_unique + 1);
+    t->codes[line_n] = (int32_t) t->n_unique;
+    t->n_unique++;
+
+    if (t->n_unique * 2 > t->n_slots && cat_grow(t) != 0) {
+        t->failed = 1;
+        return 1;
+    }
+    return 0;
+}
+
+// Like parse_categorical, for the `len` bytes at str (a stripped field); the value is stored zero
+// padded to the field's length.
+static inline int parse_categorical_span(void *output, const char *str, int len, int64_t line_n, int field_len) {
+    CatTable *t = (CatTable *) output;
+    if (t->failed)
+        return 1;
+    memcpy(t->key, str, len);
+    memset(t->key + len, 0, field_len - len);
+    return parse_categorical(output, t->key, line_n, field_len);
+}
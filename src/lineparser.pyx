@@ -2,10 +2,21 @@
 #cython: boundscheck=False, nonecheck=False, wraparound=False, cdivision=True, language_level=3
 from libc.stdlib cimport malloc, free, strtol, strtod
 from libc.stdio cimport fseek, fopen, fclose, ferror, ftell, fread, SEEK_END, SEEK_SET, FILE, printf
-from libc.string cimport strncpy, strerror
-from libc.stdint cimport int64_t, int32_t, int16_t, int8_t
+from libc.string cimport strncpy, strerror, memcmp, memcpy, memset, memchr
+from libc.stdint cimport int64_t, int32_t, int16_t, int8_t, uint64_t, uint32_t, uint16_t, uint8_t
 from libc.errno cimport errno
+from cpython.buffer cimport PyBUF_WRITABLE, PyBUF_FORMAT
+from cpython.pycapsule cimport PyCapsule_New, PyCapsule_GetPointer
+from cpython.ref cimport Py_INCREF, Py_DECREF
+from libc.errno cimport ENOMEM
+from libc.stdint cimport intptr_t, INT64_MAX
+from cython.parallel cimport prange, threadid
 import numpy as np
+import asyncio
+import os
+import queue
+import threading
+import weakref
 from libc.stdint cimport int32_t, int64_t
 
 cdef int OUT_OF_MEMORY = 1
@@ -15,14 +26,56 @@ cdef int IO_ERROR = 4
 cdef int PREMATURE_EOF = 5
 cdef int PARSE_ERROR = 6
 cdef int FILE_NOT_FOUND = 7
+# Internal: the lines of a file aren't all the same length, so it can't be split up by offset
+cdef int NOT_UNIFORM = 8
+
+cdef extern from "parsers.c" nogil:
+    ctypedef struct DateLayout:
+        uint64_t lit[4]
+        uint64_t lit_mask[4]
+        uint64_t digit_mask[4]
+        int len
+        int off[7]
+        int frac_digits
+        int unit
 
-cdef extern from "parsers.c":
     cdef int parse_f64(void *output, const char *str, int64_t line_n, int field_len)
     cdef int parse_f32(void *output, const char *str, int64_t line_n, int field_len)
     cdef int parse_i64(void *output, const char *str, int64_t line_n, int field_len)
     cdef int parse_i32(void *output, const char *str, int64_t line_n, int field_len)
     cdef int parse_i16(void *output, const char *str, int64_t line_n, int field_len)
     cdef int parse_i8(void *output, const char *str, int64_t line_n, int field_len)
+    cdef int parse_u64(void *output, const char *str, int64_t line_n, int field_len)
+    cdef int parse_u32(void *output, const char *str, int64_t line_n, int field_len)
+    cdef int parse_u16(void *output, const char *str, int64_t line_n, int field_len)
+    cdef int parse_u8(void *output, const char *str, int64_t line_n, int field_len)
+    cdef int parse_f16(void *output, const char *str, int64_t line_n, int field_len)
+    cdef int parse_bf16(void *output, const char *str, int64_t line_n, int field_len)
+    cdef int parse_bool(void *output, const char *str, int64_t line_n, int field_len, const uint64_t *true_set, const uint64_t *false_set)
+    cdef int parse_bool_packed(void *output, const char *str, int64_t line_n, int field_len, const uint64_t *true_set, const uint64_t *false_set)
+    cdef int parse_datetime(void *output, const char *str, int64_t line_n, int field_len, const DateLayout *layout)
+    cdef int parse_fixed_bytes(void *output, const char *str, int64_t line_n, int field_len)
+    cdef int parse_ucs4(void *output, const char *str, int64_t line_n, int field_len)
+    cdef int parse_ucs4_span(void *output, const char *str, int len, int64_t line_n, int field_len)
+    cdef int parse_fixed_span(void *output, const char *str, int len, int64_t line_n, int field_len)
+    cdef void strip_spaces(const char **str, int *len, int strip)
+    cdef int is_blank(const char *str, int field_len)
+    cdef uint16_t f64_to_small_float(double d, int exp_bits, int mant_bits)
+    cdef int parse_decimal(void *output, const char *str, int64_t line_n, int field_len, int scale)
+    cdef int parse_decimal_f64(void *output, const char *str, int64_t line_n, int field_len, int scale)
+
+cdef extern from "categorical.c" nogil:
+    ctypedef struct CatTable:
+        int32_t *codes
+        char *values
+        int64_t n_unique
+        int failed
+
+    cdef int cat_init(CatTable *table, int32_t *codes, int width)
+    cdef void cat_free(CatTable *table)
+    cdef void cat_reset(CatTable *table)
+    cdef int parse_categorical(void *output, const char *str, int64_t line_n, int field_len)
+    cdef int parse_categorical_span(void *output, const char *str, int len, int64_t line_n, int field_len)
 
 cdef inline int parse_bytes(void *output, const char *str, int64_t line_n, int field_len):
     cdef list loutput = <list> output
@@ -62,6 +115,16 @@ cdef enum CTy:
     String = 6
     Phantom = 7
     Bytes = 8
+    Decimal = 9
+    UInt64 = 10
+    UInt32 = 11
+    UInt16 = 12
+    UInt8 = 13
+    Float16 = 14
+    BFloat16 = 15
+    Bool = 16
+    DateTime = 17
+    Categorical = 18
 
 ctypedef int (*ParseFn)(void *, const char *, int64_t, int)
 
@@ -82,16 +145,29 @@ class Ty(IntEnum):
     """
     An enumeration for the valid field types.
     
-    - Float types are real numbers.
+    - Float types are real numbers. Float16 is IEEE half precision (`np.float16`); BFloat16 has
+        no numpy dtype, so its raw bits are stored in a `np.uint16` array (see `bfloat16_to_float32`).
+        Both are rounded to nearest from the parsed value and take half the memory of Float32.
     - Int types are signed integers.
+    - UInt types are unsigned integers; a negative value is a parse error.
+    - The decimal type is a fixed-point number with a fixed number of decimal places (the field's
+        `scale`). It is parsed exactly into an int64 holding value * 10^scale.
     - The string type is a string.
+    - The datetime type is a date and/or time in a fixed layout such as "YYYYMMDD", parsed into a
+        `np.datetime64` array (or `np.timedelta64` for time-only layouts). See `Field`.
+    - The bool type is a one character flag (e.g. Y/N, T/F, 1/0), stored in a `np.bool_` array or,
+        with `packed=True`, one bit per row in a `np.uint8` array.
+    - The categorical type is a string with few distinct values (e.g. a label or a quantum
+        number), stored as an int32 code per row plus one copy of each distinct value. See
+        `CategoricalArray`.
     - The phantom type is ... nothing. If there is a field in a file you don't need, instead of
         parsing it and wasting time and memory, use the Phantom type. This will completely
         ignore the fields contents.
 
     When choosing a data type, it is important to ensure that the numbers you will be reading can
     fit into the data type. For example, Int8 can hold numbers from -128 to 127. If your field has
-    numbers between -1000 and 5000, than Int8 is going to be the wrong data type. Int16, Int32, and
+    numbers between -1000 and 5000, than Int8 is going to be the wrong data type, and parsing will
+    fail with a `LineParsingError` on the first value that doesn't fit. Int16, Int32, and
     Int64 would all be acceptable choices, but Int16 may be consided optimal since it would
     consume the least amount of ram.
 
@@ -108,8 +184,21 @@ class Ty(IntEnum):
     String = 6
     Phantom = 7
     Bytes = 8
+    Decimal = 9
+    UInt64 = 10
+    UInt32 = 11
+    UInt16 = 12
+    UInt8 = 13
+    Float16 = 14
+    BFloat16 = 15
+    Bool = 16
+    DateTime = 17
+    Categorical = 18
+
+cdef int MAX_T = 18
 
-cdef int MAX_T = 8
+# Largest supported Decimal scale; 10^18 is the largest power of ten that fits in an int64.
+cdef int MAX_SCALE = 18
 
 def ty_to_str(ty):
     if ty == Float64:
@@ -130,6 +219,26 @@ def ty_to_str(ty):
         return "Int8"
     elif ty == Bytes:
         return "Bytes"
+    elif ty == Decimal:
+        return "Decimal"
+    elif ty == UInt64:
+        return "UInt64"
+    elif ty == UInt32:
+        return "UInt32"
+    elif ty == UInt16:
+        return "UInt16"
+    elif ty == UInt8:
+        return "UInt8"
+    elif ty == Float16:
+        return "Float16"
+    elif ty == BFloat16:
+        return "BFloat16"
+    elif ty == Bool:
+        return "Bool"
+    elif ty == DateTime:
+        return "DateTime"
+    elif ty == Categorical:
+        return "Categorical"
     else:
         raise Exception(f"{ty} is not a valid Ty")
 
@@ -138,6 +247,123 @@ def ty_to_str(ty):
 ctypedef struct CField:
     CTy ty
     int len
+    # Number of decimal places for Decimal fields
+    int scale
+    # Decimal fields are converted straight to float64 if this is set
+    bint as_float
+    # Bool fields: 256 bit character sets for true and (optionally) false values
+    uint64_t true_set[4]
+    uint64_t false_set[4]
+    # Bool fields are bit-packed if this is set
+    bint packed
+    # DateTime fields: the compiled layout
+    DateLayout layout
+    # How blank fields are handled: NULLS_NONE, NULLS_FILL or NULLS_MASK
+    int nulls
+    # The value written for blank fields, for float and integer outputs respectively
+    double null_f
+    int64_t null_i
+    # Missing value codes: parsed values equal to one of these are treated like blank fields.
+    # They are stored as the bit patterns of the output type.
+    int n_na
+    uint64_t na_bits[8]
+    # String and Bytes fields: STRINGS_OBJECT, STRINGS_S, STRINGS_U or STRINGS_VIEW
+    int strings
+    # String, Bytes and Categorical fields: which spaces are stripped, STRIP_NONE, STRIP_LEFT,
+    # STRIP_RIGHT or STRIP_BOTH
+    int strip
+
+# String and Bytes fields are output as lists of str / bytes objects
+cdef int STRINGS_OBJECT = 0
+# String and Bytes fields are copied into np.dtype('S<len>') arrays
+cdef int STRINGS_S = 1
+# Like STRINGS_S, except String fields are decoded into np.dtype('U<len>') arrays
+cdef int STRINGS_U = 2
+# String and Bytes fields aren't parsed at all; parse returns np.dtype('S<len>') views of the input
+cdef int STRINGS_VIEW = 3
+
+# Bit flags for CField.strip; the same as in parsers.c
+cdef int STRIP_NONE = 0
+cdef int STRIP_LEFT = 1
+cdef int STRIP_RIGHT = 2
+cdef int STRIP_BOTH = 3
+
+# Blank fields are parsed like any other value (0 for numbers)
+cdef int NULLS_NONE = 0
+# Blank fields are written as the field's fill value (NaN for floats)
+cdef int NULLS_FILL = 1
+# Like NULLS_FILL, but blank fields are also flagged in a mask array
+cdef int NULLS_MASK = 2
+
+cdef inline void write_null(const CField *field, void *output, uint8_t *mask, int64_t line_n) noexcept nogil:
+    # Writes the fill value of `field` for line `line_n`, and flags it in `mask` if there is one.
+    cdef CTy ty = field.ty
+    if ty == Float64 or (ty == Decimal and field.as_float):
+        (<double *> output)[line_n] = field.null_f
+    elif ty == Float32:
+        (<float *> output)[line_n] = <float> field.null_f
+    elif ty == Float16:
+        (<uint16_t *> output)[line_n] = f64_to_small_float(field.null_f, 5, 10)
+    elif ty == BFloat16:
+        (<uint16_t *> output)[line_n] = f64_to_small_float(field.null_f, 8, 7)
+    elif ty in (Int64, UInt64, Decimal, DateTime):
+        (<int64_t *> output)[line_n] = field.null_i
+    elif ty in (Int32, UInt32):
+        (<int32_t *> output)[line_n] = <int32_t> field.null_i
+    elif ty in (Int16, UInt16):
+        (<int16_t *> output)[line_n] = <int16_t> field.null_i
+    elif ty in (Int8, UInt8):
+        (<int8_t *> output)[line_n] = <int8_t> field.null_i
+    elif ty == Bool:
+        if field.packed:
+            (<uint8_t *> output)[line_n >> 3] |= <uint8_t> ((field.null_i != 0) << (line_n & 7))
+        else:
+            (<uint8_t *> output)[line_n] = field.null_i != 0
+    if mask != NULL:
+        mask[line_n] = 1
+
+# Largest number of na_values a field can have
+cdef int MAX_NA_VALUES = 8
+
+cdef inline bint is_na(const CField *field, void *output, int64_t line_n) noexcept nogil:
+    # Checks the value just parsed for line `line_n` against the field's missing value codes.
+    cdef CTy ty = field.ty
+    cdef uint64_t bits
+    cdef double na
+    cdef int k
+    if ty == Float64 or (ty == Decimal and field.as_float):
+        # Compare as floats so that 0.0 also matches -0.0. Float codes are stored as the bits of a
+        # double, which are copied out rather than read through a cast pointer.
+        for k in range(field.n_na):
+            memcpy(&na, &field.na_bits[k], sizeof(double))
+            if (<double *> output)[line_n] == na:
+                return True
+        return False
+    elif ty == Float32:
+        for k in range(field.n_na):
+            memcpy(&na, &field.na_bits[k], sizeof(double))
+            if (<float *> output)[line_n] == <float> na:
+                return True
+        return False
+    elif ty in (Int64, UInt64, Decimal, DateTime):
+        bits = (<uint64_t *> output)[line_n]
+    elif ty in (Int32, UInt32):
+        bits = (<uint32_t *> output)[line_n]
+    elif ty in (Float16, BFloat16):
+        bits = (<uint16_t *> output)[line_n]
+        # -0.0 matches 0.0, like the wider float types
+        if bits == 0x8000:
+            bits = 0
+    elif ty in (Int16, UInt16):
+        bits = (<uint16_t *> output)[line_n]
+    elif ty in (Int8, UInt8):
+        bits = (<uint8_t *> output)[line_n]
+    else:
+        return False
+    for k in range(field.n_na):
+        if bits == field.na_bits[k]:
+            return True
+    return False
 
 ctypedef struct NextLineResult:
     char *line
@@ -146,7 +372,7 @@ ctypedef struct NextLineResult:
 cdef char LF = 10
 cdef char CR = 13
 
-cdef NextLineResult fast_next_line(char* current_position, char* end_position, int line_len):
+cdef NextLineResult fast_next_line(char* current_position, char* end_position, int line_len) noexcept nogil:
     cdef char *new_pos = current_position + line_len
     cdef NextLineResult r
     r.line = NULL
@@ -158,7 +384,7 @@ cdef NextLineResult fast_next_line(char* current_position, char* end_position, i
     cdef char c = new_pos[0]
 
     # Lines should end with newline or null; if not, there is probably a bad line
-    if c not in [LF, CR, 0]:
+    if c != LF and c != CR and c != 0:
         r.line = NULL
         r.err = BAD_LINE
         return r
@@ -192,59 +418,197 @@ ctypedef struct FastParseResult:
     int field_index
 
 
-cdef FastParseResult fast_parse_internal(char *data, int64_t data_len, int64_t max_nlines, int line_len, CField *fields, void **output, int nfields):
-    cdef int64_t line_n = 0
-    cdef char *end = data + data_len
+cdef inline bint is_object_field(const CField *field) noexcept nogil:
+    # Object fields are parsed in a second pass over the lines, in order and on one thread: String
+    # and Bytes fields that produce Python objects (which needs the GIL), and Categorical fields,
+    # whose codes are shared by every row.
+    return ((field.ty == String or field.ty == Bytes) and field.strings == STRINGS_OBJECT) or \
+        field.ty == Categorical
+
+cdef inline bint is_view_field(const CField *field) noexcept nogil:
+    # View fields have no output to parse into; they become views of the input once it's parsed.
+    return (field.ty == String or field.ty == Bytes) and field.strings == STRINGS_VIEW
+
+cdef inline int parse_stripped(const CField *field, const char *t, void *output, int64_t line_n) noexcept nogil:
+    # parse_field for String, Bytes and Categorical fields with a strip mode (but not object fields).
+    cdef int n = field.len
+    strip_spaces(&t, &n, field.strip)
+    if field.ty == Categorical:
+        return parse_categorical_span(output, t, n, line_n, field.len)
+    if field.ty == String and field.strings == STRINGS_U:
+        return parse_ucs4_span(output, t, n, line_n, field.len)
+    return parse_fixed_span(output, t, n, line_n, field.len)
+
+cdef inline int parse_field(const CField *field, char *t, void *output, uint8_t *mask, int64_t line_n) noexcept nogil:
+    """
+    Parses the numeric field that starts at `t` (which must be NUL terminated) into row `line_n`
+    of `output`, applying the field's null options. Returns 0 on success.
+    """
+    cdef int res = 0
+    cdef CTy ty = field.ty
+
+    # Seems like using function pointers is slower than the jump table generated
+    # by the if statement
+    # res = (PARSE_FN_MAP[<int> ty])(output[j], t, line_n, fields[j].len)
+
+    if field.nulls != NULLS_NONE and is_blank(t, field.len):
+        write_null(field, output, mask, line_n)
+        return 0
+    elif ty == Float64:
+        res = parse_f64(output, t, line_n, field.len)
+    elif ty == Float32:
+        res = parse_f32(output, t, line_n, field.len)
+    elif ty == Int64:
+        res = parse_i64(output, t, line_n, field.len)
+    elif ty == Int32:
+        res = parse_i32(output, t, line_n, field.len)
+    elif ty == Int16:
+        res = parse_i16(output, t, line_n, field.len)
+    elif ty == Int8:
+        res = parse_i8(output, t, line_n, field.len)
+    elif ty == UInt64:
+        res = parse_u64(output, t, line_n, field.len)
+    elif ty == UInt32:
+        res = parse_u32(output, t, line_n, field.len)
+    elif ty == UInt16:
+        res = parse_u16(output, t, line_n, field.len)
+    elif ty == UInt8:
+        res = parse_u8(output, t, line_n, field.len)
+    elif ty == Float16:
+        res = parse_f16(output, t, line_n, field.len)
+    elif ty == BFloat16:
+        res = parse_bf16(output, t, line_n, field.len)
+    elif ty == Bool:
+        if field.packed:
+            res = parse_bool_packed(output, t, line_n, field.len, field.true_set, field.false_set)
+        else:
+            res = parse_bool(output, t, line_n, field.len, field.true_set, field.false_set)
+    elif ty == DateTime:
+        res = parse_datetime(output, t, line_n, field.len, &field.layout)
+    elif ty == Decimal:
+        if field.as_float:
+            res = parse_decimal_f64(output, t, line_n, field.len, field.scale)
+        else:
+            res = parse_decimal(output, t, line_n, field.len, field.scale)
+    elif field.strip != STRIP_NONE and (ty == String or ty == Bytes or ty == Categorical):
+        res = parse_stripped(field, t, output, line_n)
+    elif ty == String and field.strings == STRINGS_U:
+        res = parse_ucs4(output, t, line_n, field.len)
+    elif ty == String or ty == Bytes:
+        res = parse_fixed_bytes(output, t, line_n, field.len)
+    elif ty == Categorical:
+        res = parse_categorical(output, t, line_n, field.len)
+
+    if res == 0 and field.n_na != 0 and is_na(field, output, line_n):
+        write_null(field, output, mask, line_n)
+
+    return res
+
+cdef inline int parse_numeric_fields(char *line, int64_t line_n, const CField *fields, void **output, uint8_t **masks, int nfields) noexcept nogil:
+    """
+    Parses every field of `line` that isn't an object field (or a Phantom) into its output.
+    Returns the index of the first field that failed to parse, or -1 if they all parsed.
+    """
     cdef char *t = NULL
     cdef int length = 0, j = 0
     cdef char temp = 0
     cdef int res = 0
+    cdef CTy ty
+
+    while j < nfields:
+        t = &line[length]
+        length += fields[j].len
+        ty = fields[j].ty
+
+        if ty == Phantom or is_object_field(&fields[j]) or is_view_field(&fields[j]):
+            j += 1
+            continue
+
+        temp = line[length]
+        line[length] = 0
+        res = parse_field(&fields[j], t, output[j], masks[j], line_n)
+        line[length] = temp
+
+        if res != 0:
+            return j
+
+        j += 1
+
+    return -1
+
+cdef inline void parse_object_fields(char *line, int64_t line_n, const CField *fields, void **output, int nfields):
+    # Parses the object fields of `line`. These can't fail, except for a Categorical running out of
+    # memory, which finish_outputs reports.
+    cdef int length = 0, j = 0, n
+    cdef char *t = NULL
+    cdef char temp = 0
+    while j < nfields:
+        t = &line[length]
+        length += fields[j].len
+        if fields[j].ty == Categorical:
+            parse_field(&fields[j], t, output[j], NULL, line_n)
+        elif is_object_field(&fields[j]):
+            # The string is made straight from the stripped part of the field
+            n = fields[j].len
+            strip_spaces(<const char **> &t, &n, fields[j].strip)
+            temp = t[n]
+            t[n] = 0
+            if fields[j].ty == String:
+                parse_string(output[j], t, line_n, n)
+            else:
+                parse_bytes(output[j], t, line_n, n)
+            t[n] = temp
+        j += 1
+
+cdef bint has_object_fields(const CField *fields, int nfields):
+    for j in range(nfields):
+        if is_object_field(&fields[j]):
+            return True
+    return False
+
+cdef FastParseResult fast_parse_internal(char *data, int64_t data_len, int64_t max_nlines, int line_len, CField *fields, void **output, uint8_t **masks, int nfields):
+    """
+    Parses every line of `data`. The numeric fields are parsed in one pass without the GIL, so other
+    Python threads keep running; the object (String / Bytes) fields, if there are any, are then
+    materialized in a second pass over the lines.
+    """
+    cdef int64_t line_n = 0
+    cdef FastParseResult pr
+    cdef NextLineResult nlr
+
+    with nogil:
+        pr = parse_numeric_lines(data, data_len, line_len, fields, output, masks, nfields, 0)
+
+    if pr.err != 0 or not has_object_fields(fields, nfields):
+        return pr
+
+    nlr.line = data
+    while nlr.line != NULL and line_n < pr.line_n:
+        parse_object_fields(nlr.line, line_n, fields, output, nfields)
+        nlr = fast_next_line(nlr.line, data + data_len, line_len)
+        line_n += 1
+
+    return pr
+
+cdef FastParseResult parse_numeric_lines(char *data, int64_t data_len, int line_len, const CField *fields, void **output, uint8_t **masks, int nfields, int64_t out_base) noexcept nogil:
+    # The line loop of fast_parse_internal, for everything but object fields. Line i is written to
+    # output row out_base + i.
+    cdef int64_t line_n = 0
+    cdef char *end = data + data_len
+    cdef int j = 0
     cdef FastParseResult pr
     cdef NextLineResult nlr
     nlr.line = data
     nlr.err = 0
 
     while nlr.line != NULL:
-        j = 0
-        length = 0
-        while j < nfields:
-            t = &nlr.line[length]
-            length += fields[j].len
-            temp = nlr.line[length]
-            nlr.line[length] = 0
-            ty = fields[j].ty
-            
-            # Seems like using function pointers is slower than the jump table generated
-            # by the if statement
-            # res = (PARSE_FN_MAP[<int> ty])(output[j], t, line_n, fields[j].len)
-
-            if ty == Float64:
-                res = parse_f64(output[j], t, line_n, fields[j].len)
-            elif ty == Float32:
-                res = parse_f32(output[j], t, line_n, fields[j].len)
-            elif ty == Int64:
-                res = parse_i64(output[j], t, line_n, fields[j].len)
-            elif ty == Int32:
-                res = parse_i32(output[j], t, line_n, fields[j].len)
-            elif ty == Int16:
-                res = parse_i16(output[j], t, line_n, fields[j].len)
-            elif ty == Int8:
-                res = parse_i8(output[j], t, line_n, fields[j].len)
-            elif ty == String:
-                res = parse_string(output[j], t, line_n, fields[j].len)
-            elif ty == Bytes:
-                res = parse_bytes(output[j], t, line_n, fields[j].len)
-            elif ty == Phantom:
-                pass
-
-            if res != 0:
-                pr.err = PARSE_ERROR
-                pr.field_index = j
-                pr.line_n = line_n
-                return pr
+        j = parse_numeric_fields(nlr.line, out_base + line_n, fields, output, masks, nfields)
 
-            j += 1
-            nlr.line[length] = temp
+        if j != -1:
+            pr.err = PARSE_ERROR
+            pr.field_index = j
+            pr.line_n = line_n
+            return pr
 
         nlr = fast_next_line(nlr.line, end, line_len)
         line_n += 1
@@ -260,7 +624,439 @@ cdef FastParseResult fast_parse_internal(char *data, int64_t data_len, int64_t m
 
     return pr
 
-cdef extern from "read_whole_file.c":
+cdef int64_t uniform_stride(const char *data, int64_t data_len, int line_len, int64_t *nlines) noexcept nogil:
+    """
+    Works out the distance between the starts of consecutive lines from the terminator of the first
+    line (LF, CR or CRLF), assuming every line uses the same one. Returns -1 if the file size isn't
+    consistent with that, otherwise the stride, with the number of lines stored in `nlines`.
+    """
+    cdef int64_t stride
+    if data_len <= line_len:
+        return -1
+    if data[line_len] == LF:
+        stride = line_len + 1
+    elif data[line_len] == CR:
+        stride = line_len + (2 if data[line_len + 1] == LF else 1)
+    else:
+        return -1
+
+    if data_len % stride == 0:
+        nlines[0] = data_len // stride
+    elif data_len % stride == line_len:
+        # Last line has no terminator
+        nlines[0] = data_len // stride + 1
+    else:
+        return -1
+    return stride
+
+cdef inline bint stride_line_ok(const char *data, int64_t data_len, const char *line, int line_len,
+                                int64_t stride, const char *term) noexcept nogil:
+    # Whether `line` is a line of a strided file: it ends with `term` (unless it is the last line)
+    # and has no terminator inside it. Blank lines or a short line followed by a blank one can end
+    # on the stride too, but always leave a terminator within some line.
+    if line + line_len < data + data_len and memcmp(line + line_len, term, stride - line_len) != 0:
+        return False
+    return memchr(line, LF, line_len) == NULL and memchr(line, CR, line_len) == NULL
+
+cdef int64_t count_lines(char *data, int64_t data_len, int line_len) noexcept nogil:
+    # The number of lines fast_parse_internal would visit, for files that aren't uniform.
+    cdef int64_t n = 0
+    cdef NextLineResult nlr
+    if data_len == 0:
+        return 0
+    nlr.line = data
+    while nlr.line != NULL:
+        n += 1
+        nlr = fast_next_line(nlr.line, data + data_len, line_len)
+    return n
+
+cdef FastParseResult parse_rows_strided(char *data, int64_t data_len, int64_t stride, int line_len,
+                                        const char *term, int64_t first_line, int64_t nlines,
+                                        const CField *fields, void **output, uint8_t **masks,
+                                        int nfields, int64_t out_base) noexcept nogil:
+    """
+    Parses the non-object fields of lines [first_line, first_line + nlines) of a file whose lines
+    are all exactly `stride` bytes apart, writing line i to output row out_base + i. If a line
+    doesn't end with `term` (the terminator of the first line) or has a terminator inside it, the
+    result is NOT_UNIFORM.
+    """
+    cdef FastParseResult pr
+    cdef int64_t line_n
+    cdef char *line
+    cdef int j
+    pr.err = 0
+    pr.field_index = -1
+    pr.line_n = first_line + nlines
+
+    for line_n in range(first_line, first_line + nlines):
+        line = data + line_n * stride
+        if not stride_line_ok(data, data_len, line, line_len, stride, term):
+            pr.err = NOT_UNIFORM
+            pr.line_n = line_n
+            return pr
+
+        j = parse_numeric_fields(line, out_base + line_n, fields, output, masks, nfields)
+        if j != -1:
+            pr.err = PARSE_ERROR
+            pr.field_index = j
+            pr.line_n = line_n
+            return pr
+
+    return pr
+
+cdef FastParseResult parallel_parse_internal(char *data, int64_t data_len, int line_len, CField *fields,
+                                             void **output, uint8_t **masks, int nfields, int threads):
+    """
+    Multi-threaded version of fast_parse_internal for files where every line has the same
+    terminator, so the line (and output row) at any byte offset is known up front. The lines are
+    split into one contiguous chunk per thread, and each thread parses the numeric fields of its
+    chunk straight into its own slice of the outputs. Object fields are then parsed on this thread
+    since they need the GIL. If there is an error, the one with the lowest line number is returned.
+    If the file turns out not to be uniform, the result is NOT_UNIFORM and the caller should
+    reallocate the outputs and fall back to fast_parse_internal.
+    """
+    cdef int64_t nlines = 0
+    cdef int64_t stride = uniform_stride(data, data_len, line_len, &nlines)
+    cdef int64_t chunk_lines, first, line_n
+    cdef int k
+    cdef void *saved
+    cdef char term[2]
+    cdef FastParseResult pr
+    cdef FastParseResult *results
+
+    pr.err = NOT_UNIFORM
+    pr.line_n = 0
+    pr.field_index = -1
+    if stride < 0:
+        return pr
+
+    # Parsing temporarily overwrites the byte after each field, so threads compare against a copy
+    memcpy(term, data + line_len, stride - line_len)
+
+    # Chunks start on a multiple of 8 lines so that threads never share a byte of a bit-packed
+    # Bool output.
+    chunk_lines = (nlines + threads - 1) // threads
+    chunk_lines = (chunk_lines + 7) & ~(<int64_t> 7)
+
+    results = <FastParseResult *> malloc(sizeof(FastParseResult) * threads)
+    if results == NULL:
+        raise MemoryError()
+
+    with nogil:
+        saved = pin_caller()
+        for k in prange(threads, num_threads=threads, schedule='static', chunksize=1):
+            pool_pin(threadid())
+            first = k * chunk_lines
+            results[k] = parse_rows_strided(data, data_len, stride, line_len, term, first,
+                                            max(0, min(chunk_lines, nlines - first)),
+                                            fields, output, masks, nfields, 0)
+        unpin_thread(saved)
+
+    pr.err = 0
+    pr.line_n = nlines
+    for k in range(threads):
+        if results[k].err == NOT_UNIFORM:
+            pr = results[k]
+            break
+        if results[k].err != 0 and (pr.err == 0 or results[k].line_n < pr.line_n):
+            pr = results[k]
+    free(results)
+
+    if pr.err == 0 and has_object_fields(fields, nfields):
+        for line_n in range(nlines):
+            parse_object_fields(data + line_n * stride, line_n, fields, output, nfields)
+
+    return pr
+
+# parse_columns_strided works through the lines in blocks of about this many bytes, so that a block
+# stays in cache while each of a thread's fields is parsed from it.
+cdef int64_t COLUMN_BLOCK_BYTES = 1 << 18
+
+cdef inline bint needs_nul(CTy ty) noexcept nogil:
+    # The strtod based parsers rely on the field being NUL terminated; the rest stop at field_len.
+    return ty == Float64 or ty == Float32 or ty == Float16 or ty == BFloat16
+
+cdef FastParseResult parse_columns_strided(char *data, int64_t data_len, int64_t stride, int line_len,
+                                           const char *term, int64_t nlines, const CField *fields,
+                                           const int *offsets, const int *owned, int nowned,
+                                           void **output, uint8_t **masks) noexcept nogil:
+    """
+    Parses the fields listed in `owned` (in increasing order) for every line of a file whose lines
+    are all exactly `stride` bytes apart. Within each block of lines one field is parsed at a time,
+    so every output is written sequentially. The input is never modified: fields that have to be
+    NUL terminated are copied out first, so other threads can parse the other fields of the same
+    lines at the same time.
+    """
+    cdef FastParseResult pr
+    cdef int64_t block_lines = max(8, COLUMN_BLOCK_BYTES // stride)
+    cdef int64_t first = 0, last, err_line, line_n
+    cdef int k, j, maxlen = 0
+    cdef char *line
+    cdef char *t
+    cdef char *buf
+    pr.err = 0
+    pr.field_index = -1
+    pr.line_n = nlines
+
+    for k in range(nowned):
+        maxlen = max(maxlen, fields[owned[k]].len)
+    buf = <char *> malloc(maxlen + 1)
+    if buf == NULL:
+        pr.err = OUT_OF_MEMORY
+        pr.line_n = 0
+        return pr
+
+    while first < nlines and pr.err == 0:
+        last = min(first + block_lines, nlines)
+        for line_n in range(first, last):
+            line = data + line_n * stride
+            if not stride_line_ok(data, data_len, line, line_len, stride, term):
+                pr.err = NOT_UNIFORM
+                pr.line_n = line_n
+                free(buf)
+                return pr
+
+        # Later fields only need to be checked for errors on earlier lines than the first one found
+        err_line = last
+        for k in range(nowned):
+            j = owned[k]
+            for line_n in range(first, err_line):
+                t = data + line_n * stride + offsets[j]
+                if needs_nul(fields[j].ty):
+                    memcpy(buf, t, fields[j].len)
+                    buf[fields[j].len] = 0
+                    t = buf
+                if parse_field(&fields[j], t, output[j], masks[j], line_n) != 0:
+                    err_line = line_n
+                    pr.err = PARSE_ERROR
+                    pr.field_index = j
+                    pr.line_n = line_n
+                    break
+        first = last
+
+    free(buf)
+    return pr
+
+cdef FastParseResult parallel_columns_internal(char *data, int64_t data_len, int line_len, CField *fields,
+                                              void **output, uint8_t **masks, int nfields, int threads):
+    """
+    Like parallel_parse_internal, but the numeric fields are split between the threads instead of
+    the lines: each thread parses a few whole columns, so it only ever writes to its own outputs.
+    This suits wide schemas, where a chunk of lines touches every output column. Fields are handed
+    out widest first to the thread with the fewest bytes to parse so far.
+    """
+    cdef int64_t nlines = 0
+    cdef int64_t stride = uniform_stride(data, data_len, line_len, &nlines)
+    cdef int64_t line_n
+    cdef int g, ngroups
+    cdef void *saved
+    cdef char term[2]
+    cdef FastParseResult pr
+    cdef FastParseResult *results
+    cdef int *offsets
+    cdef int *owned
+    cdef int *group_start
+
+    pr.err = NOT_UNIFORM
+    pr.line_n = 0
+    pr.field_index = -1
+    if stride < 0:
+        return pr
+    memcpy(term, data + line_len, stride - line_len)
+
+    numeric = [j for j in range(nfields) if fields[j].ty != Phantom and not is_object_field(&fields[j])
+               and not is_view_field(&fields[j])]
+    numeric.sort(key=lambda j: -fields[j].len)
+    ngroups = min(threads, len(numeric))
+    groups = [[] for _ in range(ngroups)]
+    loads = [0] * ngroups
+    for j in numeric:
+        g = loads.index(min(loads))
+        groups[g].append(j)
+        loads[g] += fields[j].len
+
+    offsets = <int *> malloc(sizeof(int) * nfields)
+    owned = <int *> malloc(sizeof(int) * max(len(numeric), 1))
+    group_start = <int *> malloc(sizeof(int) * (ngroups + 1))
+    results = <FastParseResult *> malloc(sizeof(FastParseResult) * max(ngroups, 1))
+    if offsets == NULL or owned == NULL or group_start == NULL or results == NULL:
+        free(offsets)
+        free(owned)
+        free(group_start)
+        free(results)
+        raise MemoryError()
+
+    offsets[0] = 0
+    for j in range(1, nfields):
+        offsets[j] = offsets[j - 1] + fields[j - 1].len
+    group_start[0] = 0
+    for g in range(ngroups):
+        groups[g].sort()
+        for k, j in enumerate(groups[g]):
+            owned[group_start[g] + k] = j
+        group_start[g + 1] = group_start[g] + len(groups[g])
+
+    with nogil:
+        saved = pin_caller()
+        for g in prange(ngroups, num_threads=max(ngroups, 1), schedule='static', chunksize=1):
+            pool_pin(threadid())
+            results[g] = parse_columns_strided(data, data_len, stride, line_len, term, nlines, fields,
+                                               offsets, owned + group_start[g],
+                                               group_start[g + 1] - group_start[g], output, masks)
+        unpin_thread(saved)
+
+    pr.err = 0
+    pr.line_n = nlines
+    for g in range(ngroups):
+        if results[g].err == NOT_UNIFORM or results[g].err == OUT_OF_MEMORY:
+            pr = results[g]
+            break
+        if results[g].err != 0 and (pr.err == 0 or results[g].line_n < pr.line_n or
+                (results[g].line_n == pr.line_n and results[g].field_index < pr.field_index)):
+            pr = results[g]
+    free(offsets)
+    free(owned)
+    free(group_start)
+    free(results)
+
+    if pr.err == OUT_OF_MEMORY:
+        raise MemoryError()
+
+    if pr.err == 0 and has_object_fields(fields, nfields):
+        for line_n in range(nlines):
+            parse_object_fields(data + line_n * stride, line_n, fields, output, nfields)
+
+    return pr
+
+cdef extern from "topology.c" nogil:
+    enum: MAX_NUMA_NODES
+    cdef int numa_nodes(int *ids)
+    cdef int numa_pin(int node, void **saved)
+    cdef int pin_cpu(int cpu, void **saved)
+    cdef void unpin_thread(void *saved)
+    ctypedef struct CpuTable:
+        int ncpus
+        int cpus[1]
+    cdef void set_pool_table(CpuTable *table)
+    cdef void pool_pin(int thread)
+    cdef void *pin_caller()
+    cdef int64_t file_size(const char *path)
+    cdef int read_file_range(const char *path, char *dst, int64_t offset, int64_t length)
+
+# Thread pool settings from set_threads; the CPUs to pin to are kept in topology.c. The pool itself
+# is OpenMP's, which starts its threads on the first parallel region and keeps them for the life of
+# the process.
+cdef int default_threads = 1
+
+# Inputs smaller than this many bytes per thread get fewer threads
+cdef int64_t MIN_BYTES_PER_THREAD = 1 << 20
+
+cdef int pool_threads(threads) except -1:
+    # The thread count for a `threads` argument of one of the parse functions.
+    if threads is None:
+        return default_threads
+    if threads < 1:
+        raise ValueError("threads must be at least 1.")
+    return threads
+
+cdef inline int threads_for(int64_t nbytes, int threads) noexcept nogil:
+    # Caps `threads` so that each one gets at least MIN_BYTES_PER_THREAD of the input; small
+    # inputs are parsed on the calling thread, since waking the pool would cost more than it saves.
+    return <int> max(1, min(<int64_t> threads, nbytes // MIN_BYTES_PER_THREAD))
+
+cdef inline int output_itemsize(const CField *field) noexcept nogil:
+    # Bytes per row of a field's output array; 0 for fields without one (and for packed Bools).
+    cdef CTy ty = field.ty
+    if ty == Float64 or ty == Int64 or ty == UInt64 or ty == DateTime or ty == Decimal:
+        return 8
+    if ty == Float32 or ty == Int32 or ty == UInt32:
+        return 4
+    if ty == Int16 or ty == UInt16 or ty == Float16 or ty == BFloat16:
+        return 2
+    if ty == Int8 or ty == UInt8 or (ty == Bool and not field.packed):
+        return 1
+    if (ty == String or ty == Bytes) and (field.strings == STRINGS_S or field.strings == STRINGS_U):
+        return field.len * (4 if ty == String and field.strings == STRINGS_U else 1)
+    return 0
+
+cdef void first_touch(const CField *fields, void **output, uint8_t **masks, int nfields,
+                      int64_t first, int64_t nlines) noexcept nogil:
+    # Zeroes rows [first, first + nlines) of every numeric output, placing their pages on the
+    # calling thread's NUMA node. `first` must be a multiple of 8 for packed Bools.
+    cdef int j, size
+    for j in range(nfields):
+        size = output_itemsize(&fields[j])
+        if size != 0:
+            memset(<char *> output[j] + first * size, 0, nlines * size)
+        elif fields[j].ty == Bool and fields[j].packed:
+            memset(<char *> output[j] + first // 8, 0, (nlines + 7) // 8)
+        if masks[j] != NULL:
+            memset(masks[j] + first, 0, <size_t> nlines)
+
+cdef FastParseResult numa_parse_internal(const char *path, char *data, int64_t data_len, int64_t stride,
+                                         int64_t nlines, int line_len, CField *fields, void **output,
+                                         uint8_t **masks, int nfields, int threads):
+    """
+    parallel_parse_internal for machines with several NUMA nodes. The threads are spread evenly
+    over the nodes and pinned to them, and each one reads its own chunk of the file into `data`
+    (which must be untouched) and zeroes its own rows of the (uninitialized) outputs before parsing
+    them, so all of the memory a thread works on is local to it. `stride` and `nlines` must come
+    from uniform_stride on the first line of the file.
+    """
+    cdef int ids[MAX_NUMA_NODES]
+    cdef int nnodes = numa_nodes(ids)
+    cdef int64_t chunk_lines, first, count, start, end, line_n
+    cdef int k
+    cdef void *saved
+    cdef char term[2]
+    cdef FastParseResult pr
+    cdef FastParseResult *results
+
+    memcpy(term, data + line_len, stride - line_len)
+    chunk_lines = (nlines + threads - 1) // threads
+    chunk_lines = (chunk_lines + 7) & ~(<int64_t> 7)
+
+    results = <FastParseResult *> malloc(sizeof(FastParseResult) * threads)
+    if results == NULL:
+        raise MemoryError()
+
+    with nogil:
+        for k in prange(threads, num_threads=threads, schedule='static', chunksize=1):
+            first = k * chunk_lines
+            count = max(0, min(chunk_lines, nlines - first))
+            # Assigned here so that each thread gets its own copy
+            saved = NULL
+            numa_pin(ids[k * nnodes // threads], &saved)
+            start = min(first * stride, data_len)
+            end = data_len if k == threads - 1 else min((first + count) * stride, data_len)
+            if read_file_range(path, data + start, start, end - start) != 0:
+                results[k].err = IO_ERROR
+                results[k].line_n = first
+                results[k].field_index = -1
+            else:
+                first_touch(fields, output, masks, nfields, first, count)
+                results[k] = parse_rows_strided(data, data_len, stride, line_len, term, first, count,
+                                                fields, output, masks, nfields, 0)
+            unpin_thread(saved)
+
+    pr.err = 0
+    pr.line_n = nlines
+    pr.field_index = -1
+    for k in range(threads):
+        if results[k].err == NOT_UNIFORM or results[k].err == IO_ERROR:
+            pr = results[k]
+            break
+        if results[k].err != 0 and (pr.err == 0 or results[k].line_n < pr.line_n):
+            pr = results[k]
+    free(results)
+
+    if pr.err == 0 and has_object_fields(fields, nfields):
+        for line_n in range(nlines):
+            parse_object_fields(data + line_n * stride, line_n, fields, output, nfields)
+
+    return pr
+
+cdef extern from "read_whole_file.c" nogil:
     ctypedef struct ReadWholeFileResult:
         int64_t data_len
         char *data
@@ -269,15 +1065,146 @@ cdef extern from "read_whole_file.c":
 
     cdef ReadWholeFileResult read_whole_file_(const char *path)
 
-cdef ReadWholeFileResult read_whole_file(object filename):
+cdef bytes encode_path(object filename):
     if type(filename) not in (bytes, str):
         raise TypeError("filename must be of type str or bytes.")
     if type(filename) == str:
-        copy = bytes(filename, encoding="utf-8")
-    else:
-        copy = filename
+        return bytes(filename, encoding="utf-8")
+    return filename
+
+cdef ReadWholeFileResult start_numa_read(bytes path, int line_len, int64_t *stride, int64_t *nlines):
+    """
+    Allocates a buffer for the whole file for numa_parse_internal, but only reads enough of it for
+    uniform_stride, leaving the rest of the pages untouched. If the file can't be read this way
+    `stride` is left at -1, and the caller should read the file as usual.
+    """
+    cdef ReadWholeFileResult r
+    cdef int64_t size = file_size(path)
+    r.err = 0
+    r.data = NULL
+    r.data_len = 0
+    if size <= line_len:
+        return r
+    r.data = <char *> malloc(size + 1)
+    if r.data == NULL:
+        r.err = OUT_OF_MEMORY
+        return r
+    r.data_len = size
+    r.data[size] = 0
+    if read_file_range(path, r.data, 0, min(size, line_len + 2)) == 0:
+        stride[0] = uniform_stride(r.data, size, line_len, nlines)
+    if stride[0] < 0:
+        free(r.data)
+        r.data = NULL
+    return r
+
+cdef ReadWholeFileResult read_whole_file(object filename):
+    copy = encode_path(filename)
     cdef char *c_filename = copy
-    return read_whole_file_(c_filename)
+    cdef ReadWholeFileResult r
+    with nogil:
+        r = read_whole_file_(c_filename)
+    return r
+
+cdef class InputBuffer:
+    """
+    Owns the contents of a file read by read_whole_file and exposes them, read only, through the
+    buffer protocol, so that numpy arrays can be views of them. The memory is freed once the last
+    view is gone.
+    """
+    cdef char *data
+    cdef Py_ssize_t len
+    cdef Py_ssize_t step
+
+    def __getbuffer__(self, Py_buffer *buffer, int flags):
+        if flags & PyBUF_WRITABLE:
+            raise BufferError("The input buffer is read only.")
+        self.step = 1
+        buffer.buf = self.data
+        buffer.obj = self
+        buffer.len = self.len
+        buffer.readonly = 1
+        buffer.itemsize = 1
+        buffer.format = NULL
+        if flags & PyBUF_FORMAT:
+            buffer.format = "B"
+        buffer.ndim = 1
+        buffer.shape = &self.len
+        buffer.strides = &self.step
+        buffer.suboffsets = NULL
+        buffer.internal = NULL
+
+    def __releasebuffer__(self, Py_buffer *buffer):
+        pass
+
+    def __dealloc__(self):
+        free(self.data)
+
+cdef int64_t irregular_line(const char *data, int64_t data_len, int line_len, int64_t stride,
+                            int64_t nlines) noexcept nogil:
+    # The first of the `nlines` lines of `data` that doesn't end with the terminator of the first
+    # one or has a terminator inside it (so the lines after it aren't where the stride puts them),
+    # or -1 if there is none.
+    cdef int64_t line_n
+    for line_n in range(nlines):
+        if not stride_line_ok(data, data_len, data + line_n * stride, line_len, stride,
+                              data + line_len):
+            return line_n
+    return -1
+
+cdef void copy_view_fields(char *data, int64_t data_len, int line_len, int64_t nlines,
+                           const CField *fields, void **output, int nfields) noexcept nogil:
+    # Copies the view fields of the first `nlines` lines into S arrays, for files that aren't uniform.
+    cdef NextLineResult nlr
+    cdef int64_t line_n
+    cdef int j, offset
+    nlr.line = data
+    for line_n in range(nlines):
+        offset = 0
+        for j in range(nfields):
+            if is_view_field(&fields[j]):
+                parse_fixed_bytes(output[j], nlr.line + offset, line_n, fields[j].len)
+            offset += fields[j].len
+        nlr = fast_next_line(nlr.line, data + data_len, line_len)
+
+cdef int view_string_fields(char *data, int64_t data_len, int line_len, int64_t nlines,
+                            const CField *fields, int nfields, list py_handles) except -1:
+    """
+    Fills in the outputs of the view fields of a parsed file, taking ownership of `data`. If every
+    line is `stride` bytes long, field j of line i is at offset_j + i * stride, so each field is an
+    `np.dtype('S<len>')` array over `data` with that offset and stride, and nothing is copied.
+    Otherwise the fields are copied out into new arrays like with strings="S".
+    """
+    cdef InputBuffer input = InputBuffer()
+    input.data = data
+    input.len = data_len
+    cdef int64_t file_lines = 0
+    cdef int64_t stride = uniform_stride(data, data_len, line_len, &file_lines)
+    cdef int offset = 0
+    cdef uint8_t[:] ubptr
+    cdef void **ptrs
+
+    if stride >= 0 and file_lines == nlines and irregular_line(data, data_len, line_len, stride, nlines) == -1:
+        for j in range(nfields):
+            if is_view_field(&fields[j]):
+                py_handles[j] = np.ndarray(nlines, dtype=f"S{fields[j].len}", buffer=input,
+                                           offset=offset, strides=(stride,))
+            offset += fields[j].len
+        return 0
+
+    ptrs = <void **> malloc(sizeof(void *) * nfields)
+    if ptrs == NULL:
+        raise MemoryError()
+    for j in range(nfields):
+        ptrs[j] = NULL
+        if is_view_field(&fields[j]):
+            py_handles[j] = np.zeros(nlines, dtype=f"S{fields[j].len}")
+            if nlines > 0:
+                ubptr = py_handles[j].view(np.uint8)
+                ptrs[j] = <void *> &ubptr[0]
+    copy_view_fields(data, data_len, line_len, nlines, fields, ptrs, nfields)
+    free(ptrs)
+    return 0
 
 class LineParsingError(BaseException):
     """
@@ -289,6 +1216,10 @@ class LineParsingError(BaseException):
     a valid Int64 string.
     - Failure to parse Float64: an invalid was encountered where there should have been a valid
     Float64 string.
+    - Out of range integer: an integer field held a value that does not fit in its type, e.g. 300
+    in an Int8 field. Values are never silently wrapped.
+
+    For parse errors `line_n` and `field_index` identify the offending line (base 0) and field.
 
     Examples
     --------
@@ -315,13 +1246,14 @@ class LineParsingError(BaseException):
     
     """
 
-    def __init__(self, errno, line_n, field_ty, field_pos, filename):
+    def __init__(self, errno, line_n, field_ty, field_pos, filename, field_index=-1):
         self.errno = errno
         self.field_ty = field_ty
         self.field_pos = field_pos
         self.line_n = line_n
         self.field_pos = field_pos
         self.filename = filename
+        self.field_index = field_index
 
     def __err_location(self):
         return f"{self.filename}:{self.line_n + 1}:{self.field_pos + 1}:"
@@ -340,7 +1272,8 @@ class LineParsingError(BaseException):
             return self.__err_location() + " Encountered unexpected end of file. " + \
                     "Is your last line malformed?"
         elif self.errno == PARSE_ERROR:
-            return self.__err_location() + f" Failed to parse {ty_to_str(self.ty)}."
+            return self.__err_location() + f" Failed to parse {ty_to_str(self.field_ty)} " + \
+                    f"(field {self.field_index}): malformed or out of range value."
         else:
             return f"error number {self.errno}"
 
@@ -376,6 +1309,52 @@ class Field:
         'float', and 'str' type classes.
     length : int
         The length of the field. This must be a positive integer.
+    scale : int, optional
+        Required for Decimal fields: the number of digits after the decimal point, between 0 and
+        18. Values with more (non-zero) decimal places than this are rejected rather than rounded.
+    as_float : bool, optional
+        Decimal fields only. If True the exact scaled value is converted to a float64 (value *
+        10^-scale) as it is parsed, instead of returning the scaled int64s in a `DecimalArray`.
+    true_values : str or bytes, optional
+        Bool fields only. The characters that mean true, "YyTt1" by default. Blank fields and any
+        other character are false.
+    false_values : str or bytes, optional
+        Bool fields only. If supplied, a character that is in neither `true_values` nor
+        `false_values` is a parse error instead of false.
+    layout : str, optional
+        Required for DateTime fields. The layout of the date and/or time, made of the tokens YYYY,
+        MM, DD, HH, MM, SS and f (one per fractional second digit, at most 9); any other character
+        must appear literally. MM is minutes if it comes after HH and months otherwise. Examples:
+        "YYYYMMDD", "YYYYMMDDHHMMSS", "YYYY-MM-DD HH:MM:SS", "HH:MM:SS.ffffff". The field may be
+        wider than the layout as long as the rest is blank; a blank field is NaT. The output unit
+        is days for dates, seconds for times, and microseconds (or nanoseconds for more than 6
+        fractional digits) if there are fractional seconds; dates outside what that unit can
+        hold (1677-09-21 to 2262-04-11 in nanoseconds) are parse errors. Layouts without a date
+        produce `np.timedelta64` arrays (time since midnight) instead of `np.datetime64`.
+    packed : bool, optional
+        Bool fields only. If True the output is a `np.uint8` array holding one bit per row (row i
+        is bit i % 8 of byte i // 8, i.e. `np.unpackbits(out, bitorder='little')`), instead of a
+        `np.bool_` array.
+    nulls : str, optional
+        How blank (all space) fields are handled; only for numeric, Decimal, DateTime and Bool
+        fields. By default a blank field parses as 0 (NaT for DateTime, False for Bool). With
+        "fill", blank fields are written as `fill_value` instead. With "mask", they are also flagged
+        and the field's output is a `np.ma.MaskedArray` whose mask is True for blank fields.
+    fill_value : number, optional
+        The value written for blank fields when `nulls` is set. Defaults to NaN for floats, the
+        minimum value for signed integers and Decimal, the maximum value for unsigned integers,
+        NaT for DateTime, and False for Bool.
+    na_values : iterable, optional
+        Up to 8 missing value codes, e.g. `[-999.99, 9999]`. A field that parses to one of these
+        values is handled exactly like a blank field under `nulls`, which defaults to "fill" when
+        `na_values` is given. Values are compared after conversion to the field's type, so for
+        Float32 fields -999.99 matches "-999.99" even though neither is exactly -999.99. Not
+        supported for Bool fields.
+    strip : str, optional
+        String, Bytes and Categorical fields only. With "left", "right" or "both", the leading,
+        trailing or leading and trailing spaces of each value are removed as it is parsed (e.g.
+        "     3" becomes "3"), so that no padded copy is ever made. For `np.dtype('S<length>')` and
+        `np.dtype('U<length>')` outputs, the stripped value is zero padded, which numpy ignores.
 
     Examples
     --------
@@ -388,12 +1367,27 @@ class Field:
     Field(Float64, 6)
     >>> lineparser.Field(lineparser.Float64, 14)
     Field(Float64, 14)
+    >>> lineparser.Field(lineparser.Ty.Decimal, 12, scale=5)
+    Field(Decimal(5), 12)
+    >>> lineparser.Field(lineparser.Ty.DateTime, 8, layout="YYYYMMDD")
+    Field(DateTime('YYYYMMDD'), 8)
 
     """
 
-    def __init__(self, ty, length):
+    def __init__(self, ty, length, scale=None, as_float=False, true_values=None, false_values=None,
+                 packed=False, layout=None, nulls=None, fill_value=None, na_values=None, strip=None):
         self.ty = self.__check_ty(ty)
         self.len = self.__check_len(length)
+        self.scale = self.__check_scale(scale)
+        self.as_float = self.__check_as_float(as_float)
+        self.true_values = self.__check_flag_chars(true_values, b"YyTt1")
+        self.false_values = self.__check_flag_chars(false_values, b"")
+        self.packed = self.__check_packed(packed)
+        self.layout = self.__check_layout(layout)
+        self.nulls = self.__check_nulls("fill" if nulls is None and na_values else nulls)
+        self.fill_value = self.__check_fill_value(fill_value)
+        self.na_values = self.__check_na_values(na_values)
+        self.strip = self.__check_strip(strip)
 
     def __check_ty(self, ty):
         if type(ty) == Ty:
@@ -412,6 +1406,8 @@ class Field:
             return String
         elif ty == bytes:
             return Bytes
+        elif ty == bool:
+            return Bool
 
         raise FieldError(f"Invalid type specifier '{ty}'.")
 
@@ -422,20 +1418,269 @@ class Field:
             raise FieldError("Invalid field length: must be greater than 0.")
         return length
 
+    def __check_scale(self, scale):
+        if self.ty != Decimal:
+            if scale is not None:
+                raise FieldError("Only Decimal fields can have a scale.")
+            return 0
+        if type(scale) != int:
+            raise FieldError("Decimal fields require an int scale.")
+        if scale < 0 or scale > MAX_SCALE:
+            raise FieldError(f"Invalid Decimal scale {scale}: must be between 0 and {MAX_SCALE}.")
+        return scale
+
+    def __check_as_float(self, as_float):
+        if as_float and self.ty != Decimal:
+            raise FieldError("Only Decimal fields can be as_float.")
+        return bool(as_float)
+
+    def __check_flag_chars(self, chars, default):
+        if chars is None:
+            return default if self.ty == Bool else b""
+        if self.ty != Bool:
+            raise FieldError("Only Bool fields can have true or false values.")
+        if type(chars) == str:
+            try:
+                chars = chars.encode('ascii')
+            except UnicodeEncodeError:
+                raise FieldError("Bool true and false values must be ASCII characters.")
+        if type(chars) != bytes:
+            raise FieldError("Bool true and false values must be a str or bytes of characters.")
+        return chars
+
+    def __check_packed(self, packed):
+        if packed and self.ty != Bool:
+            raise FieldError("Only Bool fields can be packed.")
+        return bool(packed)
+
+    def __check_layout(self, layout):
+        if self.ty != DateTime:
+            if layout is not None:
+                raise FieldError("Only DateTime fields can have a layout.")
+            return None
+        if type(layout) != str:
+            raise FieldError("DateTime fields require a str layout, e.g. 'YYYYMMDD'.")
+        if len(layout) > self.len:
+            raise FieldError(f"DateTime layout '{layout}' is longer than the field.")
+        compile_layout(layout)
+        return layout
+
+    def __check_nulls(self, nulls):
+        if nulls is None:
+            return NULLS_NONE
+        if self.ty in (String, Bytes, Phantom, Categorical):
+            raise FieldError(f"{ty_to_str(self.ty)} fields can't have a nulls mode.")
+        if nulls == "fill":
+            return NULLS_FILL
+        if nulls == "mask":
+            if self.ty == Bool and self.packed:
+                raise FieldError("Packed Bool fields can't be masked; use nulls='fill' instead.")
+            return NULLS_MASK
+        raise FieldError(f"Invalid nulls mode {repr(nulls)}: must be None, 'fill' or 'mask'.")
+
+    def __check_fill_value(self, fill_value):
+        if self.nulls == NULLS_NONE:
+            if fill_value is not None:
+                raise FieldError("A fill_value requires a nulls mode.")
+            return None
+        if self.ty in (Float64, Float32, Float16, BFloat16) or (self.ty == Decimal and self.as_float):
+            return float("nan") if fill_value is None else float(fill_value)
+        if self.ty == Bool:
+            return bool(fill_value)
+        if self.ty in (Decimal, DateTime):
+            info = np.iinfo(np.int64)
+        else:
+            info = np.iinfo(numpy_dtype(self.ty))
+        if fill_value is None:
+            return info.max if info.min == 0 else info.min
+        if type(fill_value) != int or fill_value < info.min or fill_value > info.max:
+            raise FieldError(f"Invalid fill_value {repr(fill_value)} for a {self._ty_str()} field.")
+        return fill_value
+
+    def __check_na_values(self, na_values):
+        if not na_values:
+            return []
+        na_values = list(na_values)
+        if self.ty in (Bool, String, Bytes, Phantom, Categorical):
+            raise FieldError(f"{ty_to_str(self.ty)} fields can't have na_values.")
+        if len(na_values) > MAX_NA_VALUES:
+            raise FieldError(f"A field can have at most {MAX_NA_VALUES} na_values.")
+        try:
+            return [na_bits(self, v) for v in na_values]
+        except (TypeError, ValueError, OverflowError):
+            raise FieldError(f"Invalid na_values {repr(na_values)} for a {self._ty_str()} field.")
+
+    def __check_strip(self, strip):
+        if strip is None:
+            return STRIP_NONE
+        if self.ty not in (String, Bytes, Categorical):
+            raise FieldError("Only String, Bytes and Categorical fields can be stripped.")
+        modes = {"left": STRIP_LEFT, "right": STRIP_RIGHT, "both": STRIP_BOTH}
+        if strip not in modes:
+            raise FieldError(f"Invalid strip mode {repr(strip)}: must be None, 'left', 'right' or 'both'.")
+        return modes[strip]
+
     def _to_cfield(self):
         cdef CField cf
         cf.ty = self.ty
         cf.len = self.len
+        cf.scale = self.scale
+        cf.as_float = self.as_float
+        cf.true_set = char_set(self.true_values)
+        cf.false_set = char_set(self.false_values)
+        cf.packed = self.packed
+        cf.layout = compile_layout(self.layout or "")
+        cf.nulls = self.nulls
+        cf.null_f = self.fill_value if type(self.fill_value) == float else 0.0
+        cf.null_i = 0
+        if type(self.fill_value) in (int, bool):
+            # Unsigned fill values are stored by their bit pattern
+            cf.null_i = self.fill_value - (1 << 64) if self.fill_value >= (1 << 63) else self.fill_value
+        cf.n_na = len(self.na_values)
+        cf.na_bits = self.na_values + [0] * (MAX_NA_VALUES - len(self.na_values))
+        cf.strings = STRINGS_OBJECT
+        cf.strip = self.strip
         return cf
 
+    def _ty_str(self):
+        if self.ty == Decimal:
+            return f"Decimal({self.scale})"
+        if self.ty == DateTime:
+            return f"DateTime({repr(self.layout)})"
+        return ty_to_str(self.ty)
+
     def __str__(self):
-        return f"Field({ty_to_str(self.ty)}, {self.len})"
+        return f"Field({self._ty_str()}, {self.len})"
     def __repr__(self):
         return str(self)
 
-cdef CField *make_fields(list pyfields):
+cdef list char_set(bytes chars):
+    # Turns a bytes object into the 256 bit membership mask (4 uint64 words) used by CField.
+    words = [0, 0, 0, 0]
+    for c in chars:
+        words[c >> 6] |= 1 << (c & 63)
+    return words
+
+# Indices into DateLayout.off, see parsers.c
+cdef int DT_YEAR = 0, DT_MONTH = 1, DT_DAY = 2, DT_HOUR = 3, DT_MINUTE = 4, DT_SECOND = 5, DT_FRAC = 6
+
+cdef dict compile_layout(str layout):
+    # Compiles a DateTime layout string into the dict form of a DateLayout struct.
+    i, n = 0, len(layout)
+    off = [-1] * 7
+    lit = [0] * 4
+    lit_mask = [0] * 4
+    digit_mask = [0] * 4
+    frac_digits = 0
+
+    if n > 32:
+        raise FieldError(f"DateTime layout '{layout}' is longer than 32 characters.")
+
+    while i < n:
+        component, width = -1, 0
+        if layout.startswith("YYYY", i):
+            component, width = DT_YEAR, 4
+        elif layout.startswith("MM", i):
+            component, width = (DT_MINUTE if off[DT_HOUR] != -1 else DT_MONTH), 2
+        elif layout.startswith("DD", i):
+            component, width = DT_DAY, 2
+        elif layout.startswith("HH", i):
+            component, width = DT_HOUR, 2
+        elif layout.startswith("SS", i):
+            component, width = DT_SECOND, 2
+        elif layout[i] == 'f':
+            while i + frac_digits < n and layout[i + frac_digits] == 'f':
+                frac_digits += 1
+            component, width = DT_FRAC, frac_digits
+
+        if component != -1:
+            if off[component] != -1:
+                raise FieldError(f"DateTime layout '{layout}' has a repeated component.")
+            off[component] = i
+            for k in range(i, i + width):
+                digit_mask[k >> 3] |= 0xFF << ((k & 7) * 8)
+            i += width
+        else:
+            c = ord(layout[i])
+            if c > 127:
+                raise FieldError(f"DateTime layout '{layout}' contains a non-ASCII character.")
+            lit[i >> 3] |= c << ((i & 7) * 8)
+            lit_mask[i >> 3] |= 0xFF << ((i & 7) * 8)
+            i += 1
+
+    has_date = [off[DT_YEAR] != -1, off[DT_MONTH] != -1, off[DT_DAY] != -1]
+    if n > 0:
+        if any(has_date) and not all(has_date):
+            raise FieldError(f"DateTime layout '{layout}' must have all of YYYY, MM and DD or none of them.")
+        if (off[DT_MINUTE] != -1 and off[DT_HOUR] == -1) or \
+                (off[DT_SECOND] != -1 and off[DT_MINUTE] == -1) or \
+                (off[DT_FRAC] != -1 and off[DT_SECOND] == -1):
+            raise FieldError(f"DateTime layout '{layout}' skips a time component.")
+        if not any(has_date) and off[DT_HOUR] == -1:
+            raise FieldError(f"DateTime layout '{layout}' has neither a date nor a time.")
+        if frac_digits > 9:
+            raise FieldError(f"DateTime layout '{layout}' has more than 9 fractional digits.")
+
+    if off[DT_FRAC] != -1:
+        unit = 6 if frac_digits <= 6 else 9
+    elif off[DT_HOUR] != -1:
+        unit = 0
+    else:
+        unit = -1
+
+    return {'lit': lit, 'lit_mask': lit_mask, 'digit_mask': digit_mask, 'len': n, 'off': off,
+            'frac_digits': frac_digits, 'unit': unit}
+
+cdef object datetime_dtype(const DateLayout *layout):
+    # The numpy datetime64 / timedelta64 dtype a DateTime field's int64 output is viewed as.
+    unit = {-1: 'D', 0: 's', 6: 'us', 9: 'ns'}[layout.unit]
+    kind = 'datetime64' if layout.off[DT_YEAR] != -1 else 'timedelta64'
+    return np.dtype(f"{kind}[{unit}]")
+
+cdef uint64_t na_bits(field, value) except? 0:
+    # Converts a missing value code to the bit pattern the field's parser would store for it.
+    # Raises ValueError if no field value could ever be equal to it.
+    cdef DateLayout layout
+    cdef double d
+    cdef uint64_t bits
+    ty = field.ty
+    if ty in (Float64, Float32) or (ty == Decimal and field.as_float):
+        if ty == Decimal:
+            value = scaled_decimal(value, field.scale) / (10.0 ** field.scale)
+        d = float(value)
+        memcpy(&bits, &d, sizeof(double))
+        return bits
+    elif ty in (Float16, BFloat16):
+        # Adding 0.0 turns -0.0 into 0.0, which is what is_na compares zeros against
+        d = float(value) + 0.0
+        return f64_to_small_float(d, 5, 10) if ty == Float16 else f64_to_small_float(d, 8, 7)
+    elif ty == Decimal:
+        value = scaled_decimal(value, field.scale)
+        info = np.iinfo(np.int64)
+    elif ty == DateTime:
+        layout = compile_layout(field.layout)
+        value = int(np.array(value, dtype=datetime_dtype(&layout)).view(np.int64))
+        info = np.iinfo(np.int64)
+    else:
+        info = np.iinfo(numpy_dtype(ty))
+    if value != int(value) or value < info.min or value > info.max:
+        raise ValueError(value)
+    # Two's complement bit pattern of the value in the output type
+    return int(value) & ((1 << info.bits) - 1)
+
+cdef object scaled_decimal(value, int scale):
+    # The exact int64 a Decimal field with the given scale holds for `value`.
+    import decimal
+    scaled = decimal.Decimal(str(value)).scaleb(scale)
+    if scaled != scaled.to_integral_value():
+        raise ValueError(value)
+    return int(scaled)
+
+cdef CField *make_fields(list pyfields, str strings="object"):
     if len(pyfields) == 0:
         raise FieldError("Cannot have zero fields.")
+    if strings not in ("object", "S", "U"):
+        raise ValueError("strings must be 'object', 'S' or 'U'.")
 
     for field in pyfields:
         if type(field) != Field:
@@ -451,10 +1696,65 @@ cdef CField *make_fields(list pyfields):
     # Move them to C structs
     for i in range(nfields):
         fields[i] = pyfields[i]._to_cfield()
+        fields[i].strings = {"object": STRINGS_OBJECT, "S": STRINGS_S, "U": STRINGS_U}[strings]
     
     return fields
 
-def parse(list pyfields, filename):
+def set_threads(int n, affinity=None):
+    """
+
+    Sets the number of threads the parsing functions use when their `threads` argument isn't
+    given (initially 1). The threads come from one pool for the whole process, which is started
+    by the first parallel parse and then kept, so later parses only have to wake it up. Whatever
+    `threads` is, inputs are only split between as many threads as there are megabytes of input,
+    so small files are parsed on the calling thread.
+
+    Parameters
+    ----------
+    n : int
+        The default number of threads.
+    affinity : sequence of int, optional
+        CPUs to pin the threads that parse to: thread k runs on `affinity[k % len(affinity)]`.
+        The pool's threads are pinned the first time they parse and stay pinned, while thread 0,
+        the one that called the parse function, is only pinned until it returns. By default (or
+        with None) threads aren't pinned. Only supported on Linux.
+
+    Examples
+    --------
+    >>> import lineparser
+    >>> lineparser.set_threads(8, affinity=range(8))
+    >>> lineparser.get_threads()
+    8
+
+    """
+    global default_threads
+    if n < 1:
+        raise ValueError("n must be at least 1.")
+    cpus = [] if affinity is None else [int(cpu) for cpu in affinity]
+    if any(cpu < 0 for cpu in cpus):
+        raise ValueError("affinity can't hold negative CPUs.")
+    cdef CpuTable *table = NULL
+    if cpus:
+        table = <CpuTable *> malloc(sizeof(CpuTable) + sizeof(int) * len(cpus))
+        if table == NULL:
+            raise MemoryError()
+        table.ncpus = len(cpus)
+        for i, cpu in enumerate(cpus):
+            table.cpus[i] = cpu
+
+    # The table that is replaced is kept, since parses on other threads may still be pinning
+    # their threads with it
+    set_pool_table(table)
+    default_threads = n
+
+def get_threads():
+    """
+    Returns the default number of threads set by `set_threads`.
+    """
+    return default_threads
+
+def parse(list pyfields, filename, threads=None, str split="rows", bint numa=False,
+          str strings="object", str result="columns", out=None):
     """
 
     Attempts to parse the lines from `filename` using the field specfications supplied in `pyfields`
@@ -467,13 +1767,63 @@ def parse(list pyfields, filename):
     filename : `str` or `bytes`
         The filename or path which points to the fixed-width formatted file. If filename is a `str`,
         it must be utf-8 encoded
+    threads : int, optional
+        The number of threads to parse with; by default the number given to `set_threads`. If every
+        line ends with the same terminator, the file is split into one chunk of lines per thread
+        and the numeric fields of each chunk are parsed in parallel, straight into the matching
+        rows of the outputs. String and Bytes fields are still parsed on the calling thread. Files
+        with irregular line endings (e.g. blank lines) are parsed on one thread, and small files
+        use fewer threads (see `set_threads`).
+    split : `str`, optional
+        How the work is split between threads. With "rows" (the default), each thread parses every
+        field of a chunk of lines. With "columns", each thread parses a few whole fields of every
+        line instead, so it only writes to its own outputs; this tends to be faster for wide
+        schemas with many numeric fields.
+    numa : bool, optional
+        If True and `threads` > 1, the threads are spread over the machine's NUMA nodes and pinned
+        to them, and each one reads its own chunk of the file and zeroes its own rows of the
+        outputs before parsing them, so the memory each thread works on is local to its node.
+        Only supported on Linux, and only with `split="rows"`; otherwise this has no effect.
+    strings : `str`, optional
+        How String and Bytes fields are output. With "object" (the default) they are lists of `str`
+        and `bytes`. With "S" each one is an `np.dtype('S<length>')` array that the field is copied
+        straight into, without creating any Python objects; these are parsed along with the
+        numeric fields, so they are also parsed in parallel. "U" is the same except that String
+        fields are decoded from UTF-8 into `np.dtype('U<length>')` arrays. With "view" they aren't
+        parsed at all: if every line has the same terminator, each one is returned as a read only
+        `np.dtype('S<length>')` array whose elements are the fields in the input itself, found by
+        striding over it, so nothing is copied. The input stays in memory for as long as any of
+        these views do. If the line endings are irregular, the fields are copied like with "S".
+    result : `str`, optional
+        With "columns" (the default) the fields are returned as a list. With "arrow" they are
+        returned as an `ArrowTable`, which can be handed to pyarrow, polars, DuckDB, etc. through
+        the Arrow C data interface without copying. String fields must be valid UTF-8. Only
+        `strings="object"` or "S" can be used with it (the strings are laid out for Arrow either
+        way). With "records" they are returned as one numpy structured array, with a packed record
+        per line holding every field but the Phantoms (named f0, f1, ...), which each line is parsed
+        straight into. Fields are stored as the dtype they would be returned as, except that
+        String, Bytes and Categorical fields are `np.dtype('S<length>')` and Bools aren't packed.
+        The same `strings` can be used as with "arrow", `split` and `numa` are ignored, and fields
+        with nulls="mask" aren't supported.
+    out : `dict` or `ParseBuffers`, optional
+        Outputs to parse into instead of allocating new ones, for parsing many files with the same
+        format without allocating per file. Either a `ParseBuffers`, which grows as needed and
+        also reuses the buffer the file is read into, or a dict mapping the index of each field
+        (other than Phantoms) to a writeable, C contiguous 1-d numpy array of the dtype the field
+        would be returned as, with room for every line of the file. Fields with nulls="mask" take
+        an `np.ma.MaskedArray` with a full mask, and packed Bools a uint8 array with a bit per
+        line. String and Bytes fields need `strings="S"` or "U", and Categorical fields a
+        `ParseBuffers`. Lines are written from the start of the arrays, and anything after them is
+        left as it was. Can only be used with `result="columns"`, not with `strings="view"`, and
+        `numa` is ignored.
 
     Returns
     -------
     `list` of iterable
         A list of numpy arrays and lists, where the order matches that of the fields supplied in
         `pyfields`. For String fields it will be a `list` of `str`, and for Float64 and Int64 it
-        will be a numpy array.
+        will be a numpy array. With `result="arrow"`, an `ArrowTable` instead, and with
+        `result="records"` a structured numpy array. With `out`, just the number of lines parsed.
 
     Raises
     ------
@@ -485,6 +1835,8 @@ def parse(list pyfields, filename):
         If there are zero fields provided, or if the provided fields are not all of type `Field`
     MemoryError
         If there is not enough memory to read the input file and allocate field containers.
+    ValueError
+        If `out` doesn't match `pyfields`, or doesn't have room for every line of the file.
 
     Examples
     --------
@@ -504,87 +1856,2444 @@ def parse(list pyfields, filename):
      [b'   dog', b' horse']]    
 
     """
-    cdef int nfields = len(pyfields)
-    cdef CField *fields = make_fields(pyfields)
+    cdef int nthreads = pool_threads(threads)
+    if split not in ("rows", "columns"):
+        raise ValueError("split must be 'rows' or 'columns'.")
 
-    # Calculate the length of one whole line
+    if strings not in ("object", "S", "U", "view"):
+        raise ValueError("strings must be 'object', 'S', 'U' or 'view'.")
+    if result not in ("columns", "arrow", "records"):
+        raise ValueError("result must be 'columns', 'arrow' or 'records'.")
+    if result != "columns":
+        if strings not in ("object", "S"):
+            raise ValueError(f"result='{result}' requires strings='object' or 'S'.")
+        strings = "S"
+    if out is not None:
+        if result != "columns" or strings == "view":
+            raise ValueError("out can only be used with result='columns', and not with strings='view'.")
+        if isinstance(out, ParseBuffers):
+            return (<ParseBuffers> out).parse_file(pyfields, filename, nthreads, split)
+        if type(out) != dict:
+            raise TypeError("out must be a dict or a ParseBuffers.")
+        return parse_out_arrays(pyfields, filename, out, nthreads, split, strings)
+    if result == "records":
+        return parse_records(pyfields, filename, nthreads)
+    cdef bint view = strings == "view"
+    cdef int nfields = len(pyfields)
+    cdef CField *fields = make_fields(pyfields, "S" if view else strings)
     cdef int linelen = 0
-    for i in range(nfields):
-        linelen += fields[i].len
+    cdef int ids[MAX_NUMA_NODES]
+    cdef int64_t stride = -1, nlines = 0, data_len, max_lines
+    cdef bytes path
+    cdef ReadWholeFileResult file_res
+    cdef char *data = NULL
+    cdef char *owned
+    cdef AllocationResult output_obj
+    cdef void **ptrs = NULL
+    cdef uint8_t **masks = NULL
+    cdef FastParseResult pr
+    cdef list py_handles
 
-    cdef char *error = NULL
-    cdef ReadWholeFileResult file_res = read_whole_file(filename)
+    try:
+        if view:
+            for i in range(nfields):
+                # Stripped fields can't be views, so they are copied
+                fields[i].strings = STRINGS_VIEW if fields[i].strip == STRIP_NONE else STRINGS_S
 
-    if file_res.err != 0:
-        if file_res.err == OUT_OF_MEMORY:
-            raise MemoryError("There is not enough memory to read the entire input file.")
-        if file_res.err == FILE_NOT_FOUND:
-            raise Exception(f"Failed to locate file '{filename}'.")
-        
-        raise OSError(file_res.err, str(file_res.err))
+        # Calculate the length of one whole line
+        for i in range(nfields):
+            linelen += fields[i].len
 
-    cdef char *data = file_res.data
-    cdef int64_t data_len = file_res.data_len
-    cdef int64_t max_lines = data_len / linelen
+        path = encode_path(filename)
+        if numa and split == "rows" and threads_for(file_size(path), nthreads) > 1 and numa_nodes(ids) > 0:
+            file_res = start_numa_read(path, linelen, &stride, &nlines)
+            data = file_res.data
+        if stride < 0:
+            file_res = read_whole_file(filename)
+            data = file_res.data
+        check_read(file_res, filename)
+        nthreads = threads_for(file_res.data_len, nthreads)
 
-    print(f"data_len: {data_len}; max_lines: {max_lines}")
+        data_len = file_res.data_len
+        max_lines = data_len / linelen
 
-    cdef AllocationResult output_obj = allocate_field_outputs(fields, nfields, max_lines)
+        output_obj = allocate_field_outputs(fields, nfields, max_lines, stride < 0)
+        if output_obj is None or output_obj.ptrs == NULL:
+            raise Exception("Failed to allocate output: out of memory.")
+        ptrs = output_obj.ptrs
+        masks = output_obj.masks
+        pr.err = NOT_UNIFORM
 
-    if output_obj is None:
-        raise Exception("Failed to allocate output: out of memory.")
+        if stride >= 0:
+            pr = numa_parse_internal(path, data, data_len, stride, nlines, linelen, fields, ptrs,
+                                     masks, nfields, nthreads)
+            if pr.err == IO_ERROR:
+                raise OSError(f"Failed to read '{filename}'.")
+        elif nthreads > 1:
+            if split == "columns":
+                pr = parallel_columns_internal(data, data_len, linelen, fields, ptrs, masks, nfields, nthreads)
+            else:
+                pr = parallel_parse_internal(data, data_len, linelen, fields, ptrs, masks, nfields, nthreads)
 
-    cdef void **ptrs = output_obj.ptrs
-    cdef FastParseResult pr = \
-            fast_parse_internal(data, data_len, max_lines, linelen, fields, output_obj.ptrs, nfields)
+        if pr.err == NOT_UNIFORM:
+            if stride >= 0 or nthreads > 1:
+                # Start over with fresh outputs, since some were written to
+                free(ptrs)
+                free(masks)
+                ptrs = NULL
+                masks = NULL
+                output_obj = allocate_field_outputs(fields, nfields, max_lines)
+                ptrs = output_obj.ptrs
+                masks = output_obj.masks
+            pr = fast_parse_internal(data, data_len, max_lines, linelen, fields, ptrs, masks, nfields)
 
-    cdef int field_pos = -1
-    
-    if pr.err != 0:
-        field_ty = None
-        if pr.field_index != -1:
-            field_pos = 0
-            field_ty = fields[pr.field_index].ty
-            for i in range(pr.field_index):
-                field_pos += fields[i].len
+        if pr.err != 0:
+            raise parse_error(pr, fields, filename)
 
-        free(data)
+        py_handles = finish_outputs(fields, nfields, output_obj, pr.line_n)
+        if view:
+            # The views own the input from here on, even if making them fails
+            owned = data
+            data = NULL
+            view_string_fields(owned, data_len, linelen, pr.line_n, fields, nfields, py_handles)
+
+        # Remove 'Nones' from py_handles (cause by Phantom fields)
+        py_handles = list(filter(lambda p: p is not None, py_handles))
+    finally:
         free(fields)
+        free(data)
         free(ptrs)
-        print(type(filename))
-        raise LineParsingError(pr.err, pr.line_n, field_ty, field_pos, filename)
-
-    cdef list py_handles = output_obj.py_handles
-
-    nlines = pr.line_n
-
-    for i in range(nfields):
-        if fields[i].ty == Phantom:
-            continue
-        if fields[i].ty in (Float64, Float32, Int64, Int32, Int16, Int8):
-            py_handles[i].resize(nlines)
-        else:
-            py_handles[i] = py_handles[i][0:nlines]
-    
-    # Remove 'Nones' from py_handles (cause by Phantom fields)
-    py_handles = list(filter(lambda p: p is not None, py_handles))
-    
-    free(fields)
-    free(data)
-    free(ptrs)
+        free(masks)
 
+    if result == "arrow":
+        return arrow_table(pyfields, py_handles, pr.line_n, filename)
     return py_handles
 
-class DuplicateFieldNameError(Exception):
+cdef int64_t rows_in(char *data, int64_t data_len, int line_len) noexcept nogil:
+    # The number of lines parsing `data` writes to: straight from the size of the file if every
+    # line has the same terminator, otherwise by walking the lines.
+    cdef int64_t nlines = 0
+    if uniform_stride(data, data_len, line_len, &nlines) < 0:
+        nlines = count_lines(data, data_len, line_len)
+    return nlines
 
-    def __init__(self, name):
-        self.name = name
+cdef void clear_outputs(const CField *fields, void **output, uint8_t **masks, int nfields,
+                        int64_t first, int64_t nlines) noexcept nogil:
+    # Zeroes rows [first, first + nlines) of the outputs that parsing only sets bits or flags in
+    # (masks and packed Bools), so that they can be parsed into again. The bits of packed Bools
+    # outside those rows are kept.
+    cdef int j
+    cdef int64_t last = first + nlines, start = first >> 3, end = last >> 3
+    cdef uint8_t keep_low = <uint8_t> ((1 << (first & 7)) - 1)
+    cdef uint8_t keep_high = <uint8_t> ~((1 << (last & 7)) - 1)
+    cdef uint8_t *bits
+    if nlines <= 0:
+        return
+    for j in range(nfields):
+        if fields[j].ty == Bool and fields[j].packed:
+            bits = <uint8_t *> output[j]
+            if start == end:
+                bits[start] &= keep_low | keep_high
+            else:
+                bits[start] &= keep_low
+                memset(bits + start + 1, 0, <size_t> (end - start - 1))
+                if last & 7:
+                    bits[end] &= keep_high
+        if masks[j] != NULL:
+            memset(masks[j] + first, 0, nlines)
 
-    def __str__(self):
-        return f"Duplicate field name '{self.name}'."
+cdef bint same_field(const CField *a, const CField *b) noexcept nogil:
+    # Whether two fields are parsed the same way: everything make_fields sets but `strings`.
+    return a.ty == b.ty and a.len == b.len and a.scale == b.scale and a.as_float == b.as_float \
+        and memcmp(a.true_set, b.true_set, sizeof(uint64_t) * 4) == 0 \
+        and memcmp(a.false_set, b.false_set, sizeof(uint64_t) * 4) == 0 \
+        and a.packed == b.packed and memcmp(&a.layout, &b.layout, sizeof(DateLayout)) == 0 \
+        and a.nulls == b.nulls and memcmp(&a.null_f, &b.null_f, sizeof(double)) == 0 \
+        and a.null_i == b.null_i and a.n_na == b.n_na \
+        and memcmp(a.na_bits, b.na_bits, sizeof(uint64_t) * MAX_NA_VALUES) == 0 \
+        and a.strip == b.strip
 
+cdef int64_t parse_into(char *data, int64_t data_len, int line_len, CField *fields, void **ptrs,
+                        uint8_t **masks, int nfields, int64_t capacity, int nthreads, str split,
+                        filename) except -1:
+    """
+    Parses `data` into existing outputs with room for `capacity` lines, the way parse does into
+    fresh ones, and returns the number of lines. Raises a ValueError if there are more lines than
+    that. Only the rows of those lines are written to.
+    """
+    cdef int64_t nlines = rows_in(data, data_len, line_len)
+    cdef FastParseResult pr
+    if nlines > capacity:
+        raise ValueError(f"out has room for {capacity} lines, but '{filename}' has {nlines}.")
+
+    nthreads = threads_for(data_len, nthreads)
+    clear_outputs(fields, ptrs, masks, nfields, 0, nlines)
+    pr.err = NOT_UNIFORM
+    if nthreads > 1:
+        if split == "columns":
+            pr = parallel_columns_internal(data, data_len, line_len, fields, ptrs, masks, nfields, nthreads)
+        else:
+            pr = parallel_parse_internal(data, data_len, line_len, fields, ptrs, masks, nfields, nthreads)
+        if pr.err == NOT_UNIFORM:
+            clear_outputs(fields, ptrs, masks, nfields, 0, nlines)
+    if pr.err == NOT_UNIFORM:
+        pr = fast_parse_internal(data, data_len, nlines, line_len, fields, ptrs, masks, nfields)
+
+    if pr.err != 0:
+        raise parse_error(pr, fields, filename)
+    return pr.line_n
+
+cdef object out_dtype(const CField *field):
+    # The dtype of the array parse(..., out=...) expects for `field`: the one it would be returned as.
+    cdef CTy ty = field.ty
+    if ty == Decimal:
+        return np.dtype(np.float64 if field.as_float else np.int64)
+    if ty == Float16:
+        return np.dtype(np.float16)
+    if ty == BFloat16:
+        return np.dtype(np.uint16)
+    if ty == DateTime:
+        return np.dtype(datetime_dtype(&field.layout))
+    if ty == Bool:
+        return np.dtype(np.uint8 if field.packed else np.bool_)
+    if ty == String or ty == Bytes:
+        return np.dtype(f"{'U' if ty == String and field.strings == STRINGS_U else 'S'}{field.len}")
+    return np.dtype(numpy_dtype(ty))
+
+cdef int check_out_array(arr, dtype, int index) except -1:
+    if not isinstance(arr, np.ndarray) or arr.dtype != dtype or arr.ndim != 1 or \
+            not arr.flags.c_contiguous or not arr.flags.writeable:
+        raise ValueError(f"out[{index}] must be a writeable, C contiguous 1-d array of {dtype}.")
+    return 0
+
+cdef int64_t bind_output(const CField *field, int index, arr, void **ptr, uint8_t **mask) except -1:
+    # Checks that field `index` can be parsed into `arr` and points `ptr` (and `mask`, for
+    # nulls='mask') at it. Returns the number of lines it has room for.
+    mask[0] = NULL
+    if field.nulls == NULLS_MASK:
+        if not isinstance(arr, np.ma.MaskedArray) or arr.mask is np.ma.nomask:
+            raise ValueError(f"out[{index}] must be an np.ma.MaskedArray with a mask array, "
+                             f"since field {index} has nulls='mask'.")
+        check_out_array(arr.mask, np.dtype(np.bool_), index)
+        if len(arr.mask) != len(arr):
+            raise ValueError(f"The mask of out[{index}] must be as long as its data.")
+        mask[0] = <uint8_t *> buffer_address(arr.mask)
+        arr = arr.data
+    check_out_array(arr, out_dtype(field), index)
+    ptr[0] = buffer_address(arr)
+    return len(arr) * 8 if field.ty == Bool and field.packed else len(arr)
+
+cdef int64_t parse_out_arrays(list pyfields, filename, dict out, int nthreads, str split,
+                              str strings) except -1:
+    # parse(..., out=dict): parses `filename` straight into the arrays in `out`.
+    cdef int nfields = len(pyfields)
+    cdef CField *fields = make_fields(pyfields, strings)
+    cdef void **ptrs = <void **> malloc(sizeof(void *) * nfields)
+    cdef uint8_t **masks = <uint8_t **> malloc(sizeof(uint8_t *) * nfields)
+    cdef int64_t capacity = INT64_MAX
+    cdef int linelen = 0
+    cdef ReadWholeFileResult file_res
+    file_res.data = NULL
+    try:
+        if ptrs == NULL or masks == NULL:
+            raise MemoryError()
+        for i in range(nfields):
+            linelen += fields[i].len
+            ptrs[i] = NULL
+            masks[i] = NULL
+            if fields[i].ty == Phantom:
+                continue
+            if fields[i].ty == Categorical:
+                raise FieldError("Categorical fields can only be parsed into a ParseBuffers.")
+            if is_object_field(&fields[i]):
+                raise ValueError("out requires strings='S' or 'U' for String and Bytes fields.")
+            if i not in out:
+                raise ValueError(f"out has no array for field {i}.")
+            capacity = min(capacity, bind_output(&fields[i], i, out[i], &ptrs[i], &masks[i]))
+
+        file_res = read_whole_file(filename)
+        check_read(file_res, filename)
+        return parse_into(file_res.data, file_res.data_len, linelen, fields, ptrs, masks, nfields,
+                          capacity, nthreads, split, filename)
+    finally:
+        free(file_res.data)
+        free(fields)
+        free(ptrs)
+        free(masks)
+
+cdef inline int parse_record(char *line, char *record, const CField *fields, const int64_t *offsets,
+                             int nfields) noexcept nogil:
+    """
+    Parses every field of `line` but the Phantoms into its slot of `record`, a row of the array of
+    parse(..., result="records"), at offsets[j]. Returns the index of the first field that failed
+    to parse, or -1 if they all parsed.
+    """
+    cdef char *t
+    cdef int length = 0, j, res
+    cdef char temp
+    cdef uint64_t value
+
+    for j in range(nfields):
+        t = &line[length]
+        length += fields[j].len
+        if fields[j].ty == Phantom:
+            continue
+
+        temp = line[length]
+        line[length] = 0
+        if fields[j].ty == String or fields[j].ty == Bytes:
+            res = parse_field(&fields[j], t, record + offsets[j], NULL, 0)
+        else:
+            # The slots of a packed record aren't aligned, so numbers are parsed into `value` first
+            res = parse_field(&fields[j], t, &value, NULL, 0)
+            memcpy(record + offsets[j], &value, output_itemsize(&fields[j]))
+        line[length] = temp
+
+        if res != 0:
+            return j
+
+    return -1
+
+cdef FastParseResult parse_record_lines(char *data, int64_t data_len, int line_len, const CField *fields,
+                                        const int64_t *offsets, int nfields, char *records,
+                                        int64_t itemsize) noexcept nogil:
+    # parse_numeric_lines for result="records": line i is parsed into row i of `records`, whose
+    # rows are `itemsize` bytes long.
+    cdef int64_t line_n = 0
+    cdef int j
+    cdef FastParseResult pr
+    cdef NextLineResult nlr
+    nlr.line = data
+    nlr.err = 0
+    pr.field_index = -1
+
+    while nlr.line != NULL:
+        j = parse_record(nlr.line, records + line_n * itemsize, fields, offsets, nfields)
+        if j != -1:
+            pr.err = PARSE_ERROR
+            pr.field_index = j
+            pr.line_n = line_n
+            return pr
+
+        nlr = fast_next_line(nlr.line, data + data_len, line_len)
+        line_n += 1
+
+    pr.err = nlr.err
+    pr.line_n = line_n
+    return pr
+
+cdef FastParseResult parse_record_rows(char *data, int64_t data_len, int64_t stride, int line_len,
+                                       const char *term, int64_t first_line, int64_t nlines,
+                                       const CField *fields, const int64_t *offsets, int nfields,
+                                       char *records, int64_t itemsize) noexcept nogil:
+    # parse_rows_strided for result="records".
+    cdef FastParseResult pr
+    cdef int64_t line_n
+    cdef char *line
+    cdef int j
+    pr.err = 0
+    pr.field_index = -1
+    pr.line_n = first_line + nlines
+
+    for line_n in range(first_line, first_line + nlines):
+        line = data + line_n * stride
+        if not stride_line_ok(data, data_len, line, line_len, stride, term):
+            pr.err = NOT_UNIFORM
+            pr.line_n = line_n
+            return pr
 
-def named_parse(list named_fields, filename):
+        j = parse_record(line, records + line_n * itemsize, fields, offsets, nfields)
+        if j != -1:
+            pr.err = PARSE_ERROR
+            pr.field_index = j
+            pr.line_n = line_n
+            return pr
+
+    return pr
+
+cdef FastParseResult parallel_records_internal(char *data, int64_t data_len, int line_len, int64_t stride,
+                                               int64_t nlines, const CField *fields,
+                                               const int64_t *offsets, int nfields, char *records,
+                                               int64_t itemsize, int threads):
+    """
+    parallel_parse_internal for result="records", for a file whose `nlines` lines are `stride`
+    bytes apart: each thread parses a contiguous chunk of lines into its own rows of `records`.
+    """
+    cdef int64_t chunk_lines = (nlines + threads - 1) // threads, first
+    cdef int k
+    cdef void *saved
+    cdef char term[2]
+    cdef FastParseResult pr
+    cdef FastParseResult *results
+
+    memcpy(term, data + line_len, stride - line_len)
+    results = <FastParseResult *> malloc(sizeof(FastParseResult) * threads)
+    if results == NULL:
+        raise MemoryError()
+
+    with nogil:
+        saved = pin_caller()
+        for k in prange(threads, num_threads=threads, schedule='static', chunksize=1):
+            pool_pin(threadid())
+            first = k * chunk_lines
+            results[k] = parse_record_rows(data, data_len, stride, line_len, term, first,
+                                           max(0, min(chunk_lines, nlines - first)),
+                                           fields, offsets, nfields, records, itemsize)
+        unpin_thread(saved)
+
+    pr.err = 0
+    pr.line_n = nlines
+    pr.field_index = -1
+    for k in range(threads):
+        if results[k].err == NOT_UNIFORM:
+            pr = results[k]
+            break
+        if results[k].err != 0 and (pr.err == 0 or results[k].line_n < pr.line_n):
+            pr = results[k]
+    free(results)
+    return pr
+
+cdef object parse_records(list pyfields, filename, int nthreads):
+    """
+    parse(..., result="records"): parses every line of `filename` straight into its row of a
+    structured array with a packed record of every field but the Phantoms.
+    """
+    cdef int nfields = len(pyfields)
+    cdef CField *fields = make_fields(pyfields, "S")
+    cdef int64_t *offsets = <int64_t *> malloc(sizeof(int64_t) * nfields)
+    cdef int64_t itemsize = 0, stride, nlines = 0
+    cdef int linelen = 0
+    cdef char *rows
+    cdef ReadWholeFileResult file_res
+    cdef FastParseResult pr
+    names, formats, field_offsets = [], [], []
+    file_res.data = NULL
+    try:
+        if offsets == NULL:
+            raise MemoryError()
+        for i in range(nfields):
+            linelen += fields[i].len
+            offsets[i] = 0
+            if fields[i].ty == Phantom:
+                continue
+            if fields[i].nulls == NULLS_MASK:
+                raise ValueError("result='records' can't be used with nulls='mask'.")
+            if fields[i].ty == Categorical:
+                # Stored as its value, like a Bytes field
+                fields[i].ty = Bytes
+            fields[i].packed = False
+            dtype = out_dtype(&fields[i])
+            names.append(f"f{len(names)}")
+            formats.append(dtype)
+            field_offsets.append(itemsize)
+            offsets[i] = itemsize
+            itemsize += dtype.itemsize
+
+        file_res = read_whole_file(filename)
+        check_read(file_res, filename)
+        nthreads = threads_for(file_res.data_len, nthreads)
+        stride = uniform_stride(file_res.data, file_res.data_len, linelen, &nlines)
+        if stride < 0:
+            # An upper bound, trimmed once the file has been parsed
+            nlines = max(file_res.data_len // linelen, 1)
+        records = np.empty(nlines, dtype=np.dtype({"names": names, "formats": formats,
+                                                   "offsets": field_offsets, "itemsize": itemsize}))
+        rows = <char *> buffer_address(records)
+
+        pr.err = NOT_UNIFORM
+        if stride >= 0:
+            pr = parallel_records_internal(file_res.data, file_res.data_len, linelen, stride, nlines,
+                                           fields, offsets, nfields, rows, itemsize, nthreads)
+        if pr.err == NOT_UNIFORM:
+            with nogil:
+                pr = parse_record_lines(file_res.data, file_res.data_len, linelen, fields, offsets,
+                                        nfields, rows, itemsize)
+        if pr.err != 0:
+            raise parse_error(pr, fields, filename)
+        if pr.line_n != nlines:
+            records.resize(pr.line_n, refcheck=False)
+        return records
+    finally:
+        free(file_res.data)
+        free(fields)
+        free(offsets)
+
+cdef int64_t read_into(filename, char **buf, int64_t *cap) except -1:
+    # Reads `filename` into *buf, a malloc'd buffer of *cap bytes that is replaced by a bigger one
+    # if the file (plus a NUL) doesn't fit. Returns the size of the file.
+    cdef bytes path = encode_path(filename)
+    cdef int64_t size = file_size(path)
+    cdef ReadWholeFileResult file_res
+    if size < 0:
+        # file_size isn't available on this platform, or the file is missing (which
+        # read_whole_file reports)
+        file_res = read_whole_file(filename)
+        check_read(file_res, filename)
+        free(buf[0])
+        buf[0] = file_res.data
+        cap[0] = file_res.data_len + 1
+        return file_res.data_len
+    if size + 1 > cap[0]:
+        free(buf[0])
+        cap[0] = 0
+        buf[0] = <char *> malloc(size + 1)
+        if buf[0] == NULL:
+            raise MemoryError("There is not enough memory to read the entire input file.")
+        cap[0] = size + 1
+    if read_file_range(path, buf[0], 0, size) != 0:
+        raise OSError(f"Failed to read '{filename}'.")
+    buf[0][size] = 0
+    return size
+
+cdef class ParseBuffers:
+    """
+
+    Outputs that `parse(..., out=buffers)` parses into, for parsing many files with the same format
+    without allocating anything per file. The outputs, and the buffer each file is read into, are
+    kept from one parse to the next, and only grow when a file is bigger than any before it.
+
+    Parameters
+    ----------
+    pyfields : `list` of Field
+        The format of the files, as it is passed to `parse`. `parse` raises a ValueError if it is
+        given fields that differ from these in any way.
+    capacity : int, optional
+        The number of lines to make room for up front.
+    strings : `str`, optional
+        How String and Bytes fields are output: "S" (the default) or "U", as in `parse`. This is
+        used instead of the `strings` passed to `parse`.
+
+    Attributes
+    ----------
+    nlines : int
+        The number of lines parsed by the last parse.
+    capacity : int
+        The number of lines there is currently room for.
+
+    Examples
+    --------
+    >>> buffers = ParseBuffers(fields)
+    >>> for path in paths:
+    ...     parse(fields, path, out=buffers)
+    ...     total += buffers.columns()[0].sum()
+
+    """
+    cdef CField *fields
+    cdef int nfields
+    cdef int line_len
+    cdef list pyfields
+    cdef AllocationResult outputs
+    cdef char *input
+    cdef int64_t input_cap
+    cdef readonly int64_t capacity
+    cdef readonly int64_t nlines
+
+    def __init__(self, list pyfields, int64_t capacity=0, str strings="S"):
+        if strings not in ("S", "U"):
+            raise ValueError("strings must be 'S' or 'U'.")
+        self.fields = make_fields(pyfields, strings)
+        self.nfields = len(pyfields)
+        self.pyfields = list(pyfields)
+        self.line_len = 0
+        for i in range(self.nfields):
+            self.line_len += self.fields[i].len
+        self.capacity = -1
+        self.reserve(max(capacity, 0))
+
+    def __dealloc__(self):
+        free(self.fields)
+        free(self.input)
+        if self.outputs is not None:
+            free(self.outputs.ptrs)
+            free(self.outputs.masks)
+
+    def columns(self):
+        """
+        The fields of the last parse, like `parse` returns them. These are views of the buffers,
+        so the next parse overwrites them.
+        """
+        return [p for p in finish_outputs(self.fields, self.nfields, self.outputs, self.nlines, False)
+                if p is not None]
+
+    cdef int reserve(self, int64_t nlines) except -1:
+        # Makes room for `nlines` lines, at least doubling the capacity so that growth is amortized.
+        if nlines <= self.capacity:
+            return 0
+        nlines = max(nlines, 2 * self.capacity)
+        cdef AllocationResult outputs = allocate_field_outputs(self.fields, self.nfields, nlines, False)
+        if self.outputs is not None:
+            free(self.outputs.ptrs)
+            free(self.outputs.masks)
+        self.outputs = outputs
+        self.capacity = nlines
+        return 0
+
+    cdef int64_t read(self, filename) except -1:
+        return read_into(filename, &self.input, &self.input_cap)
+
+    cdef int64_t parse_file(self, list pyfields, filename, int nthreads, str split) except -1:
+        # The buffers' own fields are what is parsed with, so `pyfields` has to match them exactly
+        cdef CField *given = make_fields(pyfields, "S")
+        cdef bint same = len(pyfields) == self.nfields
+        for i in range(self.nfields if same else 0):
+            same = same and same_field(&given[i], &self.fields[i])
+        free(given)
+        if not same:
+            raise ValueError("out is a ParseBuffers for different fields.")
+        cdef int64_t data_len = self.read(filename)
+        self.reserve(data_len // self.line_len)
+        for i in range(self.nfields):
+            if self.fields[i].ty == Categorical:
+                cat_reset(&(<CategoryTable> self.outputs.py_handles[i]).table)
+        self.nlines = 0
+        self.nlines = parse_into(self.input, data_len, self.line_len, self.fields, self.outputs.ptrs,
+                                 self.outputs.masks, self.nfields, self.capacity, nthreads, split,
+                                 filename)
+        for i in range(self.nfields):
+            if self.fields[i].ty == Categorical and \
+                    (<CategoryTable> self.outputs.py_handles[i]).table.failed:
+                raise MemoryError("There is not enough memory for the categories of a Categorical field.")
+            if self.fields[i].ty == Bool and self.fields[i].packed and self.nlines & 7:
+                # The rest of the last byte may be left over from an earlier, longer file
+                (<uint8_t *> self.outputs.ptrs[i])[self.nlines >> 3] &= <uint8_t> ((1 << (self.nlines & 7)) - 1)
+        return self.nlines
+
+cdef class TableBuilder:
+    """
+
+    Builds up the fields of many files (or buffers) with the same format, e.g. for ingesting a
+    stream of small files, without concatenating the outputs of `parse`: each one is parsed straight
+    onto the end of columns that grow geometrically, and `finish` hands them over without copying.
+
+    Parameters
+    ----------
+    pyfields : `list` of Field
+        The format of the files, as it is passed to `parse`.
+    strings : `str`, optional
+        How String and Bytes fields are output: "object" (the default), "S" or "U", as in `parse`.
+        With "S" and "U" they are kept in fixed-width arrays that grow like the numeric columns.
+    capacity : int, optional
+        The number of lines to make room for up front.
+
+    Examples
+    --------
+    >>> builder = TableBuilder(fields)
+    >>> for path in paths:
+    ...     builder.append_file(path)
+    >>> columns = builder.finish()
+
+    """
+    cdef CField *fields
+    cdef int nfields
+    cdef int line_len
+    cdef AllocationResult outputs
+    cdef int64_t capacity
+    cdef int64_t nlines
+    # Each file or buffer is copied here to be parsed, since parsing writes to the byte after each
+    # field
+    cdef char *work
+    cdef int64_t work_cap
+
+    def __init__(self, list pyfields, str strings="object", int64_t capacity=0):
+        if strings not in ("object", "S", "U"):
+            raise ValueError("strings must be 'object', 'S' or 'U'.")
+        self.fields = make_fields(pyfields, strings)
+        self.nfields = len(pyfields)
+        self.line_len = 0
+        for i in range(self.nfields):
+            self.line_len += self.fields[i].len
+        self.start(max(capacity, 0))
+
+    def __dealloc__(self):
+        free(self.fields)
+        free(self.work)
+        if self.outputs is not None:
+            free(self.outputs.ptrs)
+            free(self.outputs.masks)
+
+    def __len__(self):
+        return self.nlines
+
+    def append_file(self, filename):
+        """
+        Parses the lines of `filename` onto the end of the columns, and returns how many there
+        were. If the file can't be parsed, nothing is appended.
+        """
+        cdef int64_t data_len = read_into(filename, &self.work, &self.work_cap)
+        return self.append(data_len, filename)
+
+    def append_buffer(self, buf):
+        """
+        Like `append_file`, for the lines in `buf`, a bytes-like object such as `bytes`.
+        """
+        cdef const unsigned char[::1] view = buf
+        cdef int64_t data_len = view.shape[0]
+        if data_len + 1 > self.work_cap:
+            free(self.work)
+            self.work_cap = 0
+            self.work = <char *> malloc(data_len + 1)
+            if self.work == NULL:
+                raise MemoryError()
+            self.work_cap = data_len + 1
+        if data_len > 0:
+            memcpy(self.work, &view[0], data_len)
+        self.work[data_len] = 0
+        return self.append(data_len, "<buffer>")
+
+    def finish(self):
+        """
+        Hands over the columns built so far, like `parse` returns them, and starts over with empty
+        ones. The columns are trimmed to their length in place rather than copied; with
+        strings="object" the lists of strings are handed over as they are.
+        """
+        try:
+            columns = finish_outputs(self.fields, self.nfields, self.outputs, self.nlines)
+        finally:
+            self.start(0)
+        return [c for c in columns if c is not None]
+
+    cdef int start(self, int64_t capacity) except -1:
+        # Starts over with empty columns with room for `capacity` lines.
+        cdef AllocationResult outputs = allocate_field_outputs(self.fields, self.nfields, capacity)
+        if outputs.ptrs == NULL:
+            raise MemoryError("Failed to allocate output: out of memory.")
+        if self.outputs is not None:
+            free(self.outputs.ptrs)
+            free(self.outputs.masks)
+        self.outputs = outputs
+        self.capacity = capacity
+        self.nlines = 0
+        return 0
+
+    cdef int reserve(self, int64_t nlines) except -1:
+        # Makes room for `nlines` lines in all, at least doubling the capacity so that growth is
+        # amortized. The columns are resized in place, which zeroes the new rows.
+        cdef CategoryTable table
+        if nlines <= self.capacity:
+            return 0
+        nlines = max(nlines, 2 * self.capacity)
+        for i in range(self.nfields):
+            handle = self.outputs.py_handles[i]
+            if self.fields[i].ty == Categorical:
+                table = <CategoryTable> handle
+                table.codes.resize(nlines, refcheck=False)
+                table.table.codes = <int32_t *> buffer_address(table.codes)
+            elif isinstance(handle, np.ndarray):
+                packed = self.fields[i].ty == Bool and self.fields[i].packed
+                handle.resize((nlines + 7) // 8 if packed else nlines, refcheck=False)
+                self.outputs.ptrs[i] = buffer_address(handle)
+            if self.outputs.masks[i] != NULL:
+                self.outputs.mask_handles[i].resize(nlines, refcheck=False)
+                self.outputs.masks[i] = <uint8_t *> buffer_address(self.outputs.mask_handles[i])
+        self.capacity = nlines
+        return 0
+
+    cdef int64_t append(self, int64_t data_len, filename) except -1:
+        # Parses the `data_len` bytes in `work` onto the end of the columns.
+        cdef FastParseResult pr
+        cdef int64_t consumed = 0
+        # One spare line, so that parse_window always gets to the end of the data
+        self.reserve(self.nlines + data_len // self.line_len + 1)
+        with nogil:
+            pr = parse_window(self.work, data_len, self.line_len, True, self.nlines,
+                              self.capacity - self.nlines, self.fields, self.outputs.ptrs,
+                              self.outputs.masks, self.nfields, &consumed)
+        if pr.err != 0:
+            # Undo what the lines before the bad one set
+            clear_outputs(self.fields, self.outputs.ptrs, self.outputs.masks, self.nfields,
+                          self.nlines, pr.line_n + 1)
+            raise parse_error(pr, self.fields, filename)
+        if has_object_fields(self.fields, self.nfields):
+            parse_window_objects(self.work, pr.line_n, self.line_len, self.nlines, self.fields,
+                                 self.outputs.ptrs, self.nfields)
+        self.nlines += pr.line_n
+        return pr.line_n
+
+ctypedef struct FileTask:
+    # Lines [first_line, first_line + nlines) of file `file`. If nlines is -1 the file isn't
+    # uniform, and the whole thing is parsed by one thread.
+    int file
+    int64_t first_line
+    int64_t nlines
+
+# The smallest number of lines parse_many will hand to a thread at once
+cdef int64_t MIN_TASK_LINES = 16384
+
+def parse_many(list pyfields, paths, threads=None, bint concat=True, bint file_ids=False,
+               str strings="object"):
+    """
+
+    Parses every file in `paths` with the same field specifications. All of the files are read and
+    parsed on one pool of `threads` threads: each file is split into tasks of roughly equal numbers
+    of lines, which the threads take one at a time as they become free, so a mix of large and small
+    files keeps every thread busy.
+
+    Parameters
+    ----------
+    pyfields : `list` of Field
+        This list describes the fixed-width file format shared by every file. The Fields in the
+        list ought to be in the same order that they appear in the file.
+    paths : iterable of `str` or `bytes`
+        The files to parse.
+    threads : int, optional
+        The number of threads to read and parse with; by default the number given to
+        `set_threads`. As with `parse`, String and Bytes fields are parsed on the calling thread.
+    concat : bool, optional
+        If True (the default), the rows of every file are parsed into one set of outputs, in the
+        order of `paths`. Otherwise there is one set of outputs per file.
+    file_ids : bool, optional
+        If True, an extra `np.int32` array is appended to the concatenated outputs holding the
+        index in `paths` of the file each row came from. Only valid with `concat=True`.
+    strings : `str`, optional
+        How String and Bytes fields are output: "object" (the default), "S" or "U", as for `parse`.
+        "view" isn't supported.
+
+    Returns
+    -------
+    `list` of iterable, or `list` of `list` of iterable
+        With `concat=True`, a single list of outputs just like the one `parse` returns. Otherwise a
+        list holding the output of `parse` for each file.
+
+    Raises
+    ------
+    LineParsingError
+        If there is a bad line or a bad field in any of the files. If there is more than one, it is
+        the first one in the first file that has an error.
+    OSError
+        If this function fails to open one of the files
+    FieldError
+        If there are zero fields provided, or if the provided fields are not all of type `Field`
+    MemoryError
+        If there is not enough memory to read the input files and allocate field containers.
+
+    Examples
+    --------
+    >>> from lineparser import parse_many, Field
+    >>> fields = [Field(int, 3), Field(str, 6)]
+    >>> open("a.lines", "w").write(" 15   dog\\n146 horse\\n")
+    20
+    >>> open("b.lines", "w").write("  7   cat\\n")
+    10
+    >>> parse_many(fields, ["a.lines", "b.lines"], file_ids=True)
+    [array([ 15, 146,   7]), ['   dog', ' horse', '   cat'], array([0, 0, 1], dtype=int32)]
+    >>> parse_many(fields, ["a.lines", "b.lines"], concat=False)
+    [[array([ 15, 146]), ['   dog', ' horse']], [array([7]), ['   cat']]]
+
+    """
+    cdef int nthreads = pool_threads(threads)
+    if file_ids and not concat:
+        raise ValueError("file_ids can only be used with concat=True.")
+
+    paths = list(paths)
+    cdef list names = []
+    for path in paths:
+        if type(path) not in (bytes, str):
+            raise TypeError("paths must all be of type str or bytes.")
+        names.append(bytes(path, encoding="utf-8") if type(path) == str else path)
+
+    cdef int nfiles = len(names)
+    cdef int nfields = len(pyfields)
+    cdef CField *fields = make_fields(pyfields, strings)
+    cdef int linelen = 0
+    for i in range(nfields):
+        linelen += fields[i].len
+
+    # Files are concatenated at arbitrary rows, so threads could share a byte of a bit-packed Bool
+    # output; those fields are parsed one byte per row and packed at the end.
+    cdef list packed = []
+    if concat:
+        for i in range(nfields):
+            if fields[i].ty == Bool and fields[i].packed:
+                fields[i].packed = False
+                packed.append(i)
+
+    cdef char **c_names = <char **> malloc(sizeof(char *) * max(nfiles, 1))
+    cdef ReadWholeFileResult *files = <ReadWholeFileResult *> malloc(sizeof(ReadWholeFileResult) * max(nfiles, 1))
+    cdef int64_t *strides = <int64_t *> malloc(sizeof(int64_t) * max(nfiles, 1))
+    cdef int64_t *counts = <int64_t *> malloc(sizeof(int64_t) * max(nfiles, 1))
+    cdef int64_t *out_base = <int64_t *> malloc(sizeof(int64_t) * max(nfiles, 1))
+    cdef char *terms = <char *> malloc(2 * max(nfiles, 1))
+    cdef void ***file_ptrs = <void ***> malloc(sizeof(void **) * max(nfiles, 1))
+    cdef uint8_t ***file_masks = <uint8_t ***> malloc(sizeof(uint8_t **) * max(nfiles, 1))
+    cdef FileTask *tasks = NULL
+    cdef FastParseResult *results = NULL
+    cdef FastParseResult pr
+    cdef list allocations = []
+    cdef AllocationResult output_obj
+    cdef int64_t total, task_lines, first, line_n
+    cdef int ntasks, k, t
+    cdef int64_t data_len
+    cdef void *saved
+    cdef NextLineResult nlr
+
+    try:
+        if c_names == NULL or files == NULL or strides == NULL or counts == NULL or \
+                out_base == NULL or terms == NULL or file_ptrs == NULL or file_masks == NULL:
+            raise MemoryError()
+        for k in range(nfiles):
+            c_names[k] = names[k]
+            files[k].data = NULL
+            file_ptrs[k] = NULL
+            file_masks[k] = NULL
+
+        with nogil:
+            saved = pin_caller()
+            for k in prange(nfiles, num_threads=min(nthreads, max(nfiles, 1)), schedule='dynamic', chunksize=1):
+                pool_pin(threadid())
+                files[k] = read_whole_file_(c_names[k])
+                if files[k].err == 0:
+                    strides[k] = uniform_stride(files[k].data, files[k].data_len, linelen, &counts[k])
+                    if strides[k] < 0:
+                        counts[k] = count_lines(files[k].data, files[k].data_len, linelen)
+            unpin_thread(saved)
+
+        data_len = 0
+        for k in range(nfiles):
+            data_len += files[k].data_len
+        nthreads = threads_for(data_len, nthreads)
+
+        for k in range(nfiles):
+            check_read(files[k], paths[k])
+            if strides[k] >= 0:
+                memcpy(terms + 2 * k, files[k].data + linelen, strides[k] - linelen)
+
+        while True:
+            total = 0
+            for k in range(nfiles):
+                total += counts[k]
+
+            for output_obj in allocations:
+                free(output_obj.ptrs)
+                free(output_obj.masks)
+            allocations = []
+            first = 0
+            for k in range(nfiles if not concat else 1):
+                # allocate_field_outputs can't make empty outputs; they are trimmed afterwards
+                output_obj = allocate_field_outputs(fields, nfields, max(total if concat else counts[k], 1))
+                if output_obj.ptrs == NULL:
+                    raise MemoryError("Failed to allocate output: out of memory.")
+                allocations.append(output_obj)
+            for k in range(nfiles):
+                output_obj = allocations[0 if concat else k]
+                out_base[k] = first if concat else 0
+                file_ptrs[k] = output_obj.ptrs
+                file_masks[k] = output_obj.masks
+                first += counts[k]
+
+            # Tasks are a multiple of 8 lines long, so they start on a byte boundary of a
+            # bit-packed Bool output (which are only left packed when each file has its own).
+            task_lines = max(MIN_TASK_LINES, total // (8 * nthreads))
+            task_lines = (task_lines + 7) & ~(<int64_t> 7)
+            ntasks = 0
+            for k in range(nfiles):
+                if strides[k] < 0:
+                    ntasks += 1 if counts[k] > 0 else 0
+                else:
+                    ntasks += (counts[k] + task_lines - 1) // task_lines
+
+            free(tasks)
+            free(results)
+            tasks = <FileTask *> malloc(sizeof(FileTask) * max(ntasks, 1))
+            results = <FastParseResult *> malloc(sizeof(FastParseResult) * max(ntasks, 1))
+            if tasks == NULL or results == NULL:
+                raise MemoryError()
+
+            # Whole files first, since they are likely the biggest tasks
+            t = 0
+            for k in range(nfiles):
+                if strides[k] < 0 and counts[k] > 0:
+                    tasks[t].file = k
+                    tasks[t].first_line = 0
+                    tasks[t].nlines = -1
+                    t += 1
+            for k in range(nfiles):
+                if strides[k] >= 0:
+                    for first in range(0, counts[k], task_lines):
+                        tasks[t].file = k
+                        tasks[t].first_line = first
+                        tasks[t].nlines = min(task_lines, counts[k] - first)
+                        t += 1
+
+            with nogil:
+                saved = pin_caller()
+                for t in prange(ntasks, num_threads=nthreads, schedule='dynamic', chunksize=1):
+                    pool_pin(threadid())
+                    k = tasks[t].file
+                    if tasks[t].nlines < 0:
+                        results[t] = parse_numeric_lines(files[k].data, files[k].data_len, linelen,
+                                                         fields, file_ptrs[k], file_masks[k],
+                                                         nfields, out_base[k])
+                    else:
+                        results[t] = parse_rows_strided(files[k].data, files[k].data_len, strides[k],
+                                                        linelen, terms + 2 * k, tasks[t].first_line,
+                                                        tasks[t].nlines, fields, file_ptrs[k],
+                                                        file_masks[k], nfields, out_base[k])
+                unpin_thread(saved)
+
+            # Files that turned out not to be uniform are counted line by line, and everything
+            # is parsed again.
+            k = -1
+            for t in range(ntasks):
+                if results[t].err == NOT_UNIFORM:
+                    k = tasks[t].file
+                    strides[k] = -1
+                    counts[k] = count_lines(files[k].data, files[k].data_len, linelen)
+            if k == -1:
+                break
+
+        pr.err = 0
+        k = -1
+        for t in range(ntasks):
+            if results[t].err != 0 and (k == -1 or tasks[t].file < k or
+                    (tasks[t].file == k and results[t].line_n < pr.line_n)):
+                pr = results[t]
+                k = tasks[t].file
+        if pr.err != 0:
+            raise parse_error(pr, fields, paths[k])
+
+        if has_object_fields(fields, nfields):
+            for k in range(nfiles):
+                if strides[k] >= 0:
+                    for line_n in range(counts[k]):
+                        parse_object_fields(files[k].data + line_n * strides[k], out_base[k] + line_n,
+                                            fields, file_ptrs[k], nfields)
+                else:
+                    nlr.line = files[k].data
+                    for line_n in range(counts[k]):
+                        parse_object_fields(nlr.line, out_base[k] + line_n, fields, file_ptrs[k], nfields)
+                        nlr = fast_next_line(nlr.line, files[k].data + files[k].data_len, linelen)
+
+        if not concat:
+            return [list(filter(lambda p: p is not None,
+                                finish_outputs(fields, nfields, allocations[k], counts[k])))
+                    for k in range(nfiles)]
+
+        py_handles = finish_outputs(fields, nfields, allocations[0], total)
+        for i in packed:
+            py_handles[i] = np.packbits(py_handles[i], bitorder='little')
+        py_handles = list(filter(lambda p: p is not None, py_handles))
+        if file_ids:
+            py_handles.append(np.repeat(np.arange(nfiles, dtype=np.int32),
+                                        [counts[k] for k in range(nfiles)]))
+        return py_handles
+    finally:
+        for output_obj in allocations:
+            free(output_obj.ptrs)
+            free(output_obj.masks)
+        if files != NULL:
+            for k in range(nfiles):
+                free(files[k].data)
+        free(c_names)
+        free(files)
+        free(strides)
+        free(counts)
+        free(out_base)
+        free(terms)
+        free(file_ptrs)
+        free(file_masks)
+        free(tasks)
+        free(results)
+        free(fields)
+
+cdef FastParseResult parse_window(char *data, int64_t data_len, int line_len, bint at_eof,
+                                  int64_t out_base, int64_t max_lines, const CField *fields,
+                                  void **output, uint8_t **masks, int nfields,
+                                  int64_t *consumed) noexcept nogil:
+    """
+    Parses the numeric fields of up to `max_lines` whole lines from the start of `data`, a window
+    of a file that is being read a piece at a time, into rows out_base, out_base + 1, ... of the
+    outputs. pr.line_n is the number of lines parsed and `consumed` is set to the number of bytes
+    they (and any line terminators after them) take up. Unless `at_eof` is set, a line is only
+    parsed once the byte after it is in the window. There must be one writable byte after the end
+    of the window.
+    """
+    cdef FastParseResult pr
+    cdef int64_t pos = 0, n = 0
+    cdef int j
+    pr.err = 0
+    pr.field_index = -1
+
+    while n < max_lines:
+        # Terminators (and so blank lines) are skipped, like fast_next_line does
+        while pos < data_len and (data[pos] == LF or data[pos] == CR):
+            pos += 1
+        if pos == data_len or (pos + line_len >= data_len and not at_eof):
+            break
+        if pos + line_len > data_len:
+            pr.err = PREMATURE_EOF
+            break
+        if pos + line_len < data_len and data[pos + line_len] != LF and data[pos + line_len] != CR:
+            pr.err = BAD_LINE
+            break
+        j = parse_numeric_fields(data + pos, out_base + n, fields, output, masks, nfields)
+        if j != -1:
+            pr.err = PARSE_ERROR
+            pr.field_index = j
+            break
+        pos += line_len
+        n += 1
+
+    pr.line_n = n
+    consumed[0] = pos
+    return pr
+
+cdef void parse_window_objects(char *data, int64_t nlines, int line_len, int64_t out_base,
+                               const CField *fields, void **output, int nfields):
+    # The object field pass for the first `nlines` lines of a window parse_window succeeded on.
+    cdef int64_t pos = 0, n
+    for n in range(nlines):
+        while data[pos] == LF or data[pos] == CR:
+            pos += 1
+        parse_object_fields(data + pos, out_base + n, fields, output, nfields)
+        pos += line_len
+
+cdef class BatchParser:
+    """
+    The parsing side of iter_batches: bytes of the file are appended to a window, and whole lines
+    are parsed out of it into batches of `batch_rows` rows.
+    """
+    cdef CField *fields
+    cdef int nfields
+    cdef int line_len
+    cdef int64_t batch_rows
+    cdef object filename
+    # The window is work[start:end]; whatever is left of it is moved to the front on append.
+    cdef char *work
+    cdef int64_t start, end, cap
+    # Lines parsed so far, for error messages
+    cdef int64_t lines_done
+
+    def __dealloc__(self):
+        free(self.fields)
+        free(self.work)
+
+    cdef AllocationResult new_batch(self):
+        cdef AllocationResult batch = allocate_field_outputs(self.fields, self.nfields, self.batch_rows)
+        if batch.ptrs == NULL:
+            raise MemoryError("Failed to allocate output: out of memory.")
+        return batch
+
+    cdef void reset_batch(self, AllocationResult batch):
+        # Gets a batch that has been handed out before ready to be filled again.
+        first_touch(self.fields, batch.ptrs, batch.masks, self.nfields, 0, self.batch_rows)
+        for j in range(self.nfields):
+            if self.fields[j].ty == Categorical:
+                # Each batch has its own categories
+                batch.py_handles[j] = category_table((<CategoryTable> batch.py_handles[j]).codes,
+                                                     self.fields[j].len)
+                batch.ptrs[j] = <void *> &(<CategoryTable> batch.py_handles[j]).table
+            elif is_object_field(&self.fields[j]):
+                batch.py_handles[j] = []
+                batch.ptrs[j] = <void *> batch.py_handles[j]
+
+    cdef void append(self, const char *chunk, int64_t n):
+        memcpy(self.work, self.work + self.start, self.end - self.start)
+        self.end -= self.start
+        self.start = 0
+        memcpy(self.work + self.end, chunk, n)
+        self.end += n
+
+    cdef int64_t fill(self, AllocationResult batch, int64_t rows, bint at_eof) except -1:
+        # Parses as many lines from the window as fit in rows [rows, batch_rows) of `batch`, and
+        # returns how many that was.
+        cdef FastParseResult pr
+        cdef int64_t consumed = 0
+        cdef char saved = self.work[self.end]
+        with nogil:
+            pr = parse_window(self.work + self.start, self.end - self.start, self.line_len, at_eof,
+                              rows, self.batch_rows - rows, self.fields, batch.ptrs, batch.masks,
+                              self.nfields, &consumed)
+        self.work[self.end] = saved
+        if pr.err != 0:
+            pr.line_n += self.lines_done
+            raise parse_error(pr, self.fields, self.filename)
+        if has_object_fields(self.fields, self.nfields):
+            parse_window_objects(self.work + self.start, pr.line_n, self.line_len, rows,
+                                 self.fields, batch.ptrs, self.nfields)
+        self.start += consumed
+        self.lines_done += pr.line_n
+        return pr.line_n
+
+cdef BatchParser make_batch_parser(list pyfields, filename, int64_t batch_rows, int64_t chunk_bytes,
+                                   str strings):
+    cdef BatchParser p = BatchParser()
+    p.nfields = len(pyfields)
+    p.fields = make_fields(pyfields, strings)
+    p.line_len = 0
+    for i in range(p.nfields):
+        p.line_len += p.fields[i].len
+    p.batch_rows = batch_rows
+    p.filename = filename
+    # At most one partial line is left in the window when more is appended, plus the byte that
+    # gets overwritten after the last line.
+    p.cap = chunk_bytes + p.line_len + 2
+    p.work = <char *> malloc(p.cap)
+    if p.work == NULL:
+        raise MemoryError()
+    p.start = p.end = p.lines_done = 0
+    return p
+
+class HelperPool:
+    """
+    The threads that run Python code in the background for iter_batches, iter_batches_async and
+    parse_async. A job goes to an idle thread if there is one and to a new thread otherwise, and a
+    thread waits for the next job once its own is done, so threads are started once and then
+    reused. Unlike a fixed-size executor it never makes a job wait for a free thread, since the
+    reader of one iter_batches waiting behind the parser of another could deadlock.
+    """
+
+    def __init__(self):
+        self.reset()
+
+    def reset(self):
+        # Forgets the threads, which only the parent process has after a fork
+        self.lock = threading.Lock()
+        self.jobs = queue.SimpleQueue()
+        self.idle = 0
+
+    def submit(self, fn, *args):
+        # Runs fn(*args) on a pool thread, and returns an Event that is set once it has returned.
+        # fn has to handle its own exceptions.
+        done = threading.Event()
+        with self.lock:
+            start = self.idle == 0
+            if not start:
+                self.idle -= 1
+        self.jobs.put((fn, args, done))
+        if start:
+            threading.Thread(target=self.work, name="lineparser-helper", daemon=True).start()
+        return done
+
+    def work(self):
+        while True:
+            fn, args, done = self.jobs.get()
+            try:
+                fn(*args)
+            finally:
+                done.set()
+            # Nothing of the job is kept alive while the thread waits
+            fn = args = done = None
+            with self.lock:
+                self.idle += 1
+
+helper_pool = HelperPool()
+os.register_at_fork(after_in_child=helper_pool.reset)
+
+def put_until_stopped(q, item, stop):
+    # Blocks until `item` is in `q`, or returns False if `stop` is set first.
+    while not stop.is_set():
+        try:
+            q.put(item, timeout=0.05)
+            return True
+        except queue.Full:
+            pass
+    return False
+
+def get_until_stopped(q, stop):
+    # Blocks until there is an item in `q`, or returns None if `stop` is set first.
+    while not stop.is_set():
+        try:
+            return q.get(timeout=0.05)
+        except queue.Empty:
+            pass
+    return None
+
+def read_chunks(file, free_chunks, chunks, stop):
+    # Reader thread of iter_batches: fills free chunk buffers from `file` and queues them up
+    # along with their lengths, then queues None at the end of the file.
+    try:
+        while True:
+            chunk = get_until_stopped(free_chunks, stop)
+            if chunk is None:
+                return
+            n = file.readinto(chunk)
+            if n == 0:
+                put_until_stopped(chunks, None, stop)
+                return
+            put_until_stopped(chunks, (chunk, n), stop)
+    except BaseException as e:
+        put_until_stopped(chunks, e, stop)
+
+def parse_chunks(BatchParser p, free_chunks, chunks, free_batches, batches, stop):
+    # Parser thread of iter_batches: appends chunks to the window and queues up each batch as it
+    # fills, then a final partial batch and None.
+    cdef AllocationResult batch
+    cdef int64_t rows = 0
+    cdef const unsigned char[::1] view
+    try:
+        batch = get_until_stopped(free_batches, stop)
+        while batch is not None:
+            item = get_until_stopped(chunks, stop)
+            if isinstance(item, BaseException):
+                raise item
+            if item is not None:
+                view = item[0]
+                p.append(<const char *> &view[0], item[1])
+                view = None
+                put_until_stopped(free_chunks, item[0], stop)
+
+            while True:
+                rows += p.fill(batch, rows, item is None)
+                if rows < p.batch_rows:
+                    break
+                if not put_until_stopped(batches, (batch, rows), stop):
+                    return
+                batch = get_until_stopped(free_batches, stop)
+                if batch is None:
+                    return
+                p.reset_batch(batch)
+                rows = 0
+
+            if item is None:
+                if rows > 0:
+                    put_until_stopped(batches, (batch, rows), stop)
+                put_until_stopped(batches, None, stop)
+                return
+    except BaseException as e:
+        put_until_stopped(batches, e, stop)
+
+def iter_batches(list pyfields, filename, int batch_rows=65536, int depth=2, str strings="object"):
+    """
+
+    Parses `filename` in batches of `batch_rows` lines, yielding each batch as soon as it has been
+    parsed. The file is read and parsed on two background threads while the caller works on the
+    batches it has been given, and at most `depth` parsed batches wait to be picked up; once
+    there are that many, reading and parsing pause until the caller catches up.
+
+    The numpy arrays of a batch are reused for later batches, so they are only valid until the
+    next batch is requested. Copy them to keep them around for longer.
+
+    Parameters
+    ----------
+    pyfields : `list` of Field
+        This list describes the fixed-width file format. The Fields in the list ought to be in the
+        same order that they appear in the file.
+    filename : `str` or `bytes`
+        The filename or path which points to the fixed-width formatted file.
+    batch_rows : int, optional
+        The number of lines in each batch. The last batch may have fewer.
+    depth : int, optional
+        The number of parsed batches that may be waiting to be picked up.
+    strings : `str`, optional
+        How String and Bytes fields are output: "object" (the default), "S" or "U", as for `parse`
+        ("view" isn't supported). With "S" or "U" their arrays are reused along with the numeric
+        ones.
+
+    Yields
+    ------
+    `list` of iterable
+        The columns of each batch, in the same form `parse` returns them.
+
+    Raises
+    ------
+    LineParsingError
+        If there is a bad line (wrong length), or a bad field (failed to parse). The batches
+        before the one with the error are yielded first.
+    OSError
+        If this function fails to open or read `filename`
+    FieldError
+        If there are zero fields provided, or if the provided fields are not all of type `Field`
+
+    Examples
+    --------
+    >>> from lineparser import iter_batches, Field
+    >>> total = 0
+    >>> for [a] in iter_batches([Field(float, 12)], "data/small_data.par", batch_rows=64):
+    ...     total += a.sum()
+
+    """
+    if batch_rows < 1:
+        raise ValueError("batch_rows must be at least 1.")
+    if depth < 1:
+        raise ValueError("depth must be at least 1.")
+
+    batches = queue.Queue(maxsize=depth)
+    cdef BatchStream stream = BatchStream(pyfields, filename, batch_rows, depth, strings, batches)
+    try:
+        while True:
+            item = batches.get()
+            if item is None:
+                return
+            if isinstance(item, BaseException):
+                raise item
+            yield stream.columns(item)
+            stream.release(item)
+    finally:
+        stream.close()
+
+cdef class BatchStream:
+    """
+    The reader and parser threads behind iter_batches and iter_batches_async. Each parsed batch is
+    put into `batches` as a (batch, rows) pair, followed by None at the end of the file, or by the
+    exception if something goes wrong. `batches` only needs a queue.Queue style put method.
+    """
+    cdef BatchParser p
+    cdef object file
+    cdef object stop
+    cdef object free_batches
+    cdef list all_batches
+    # Set once the reader and parser have returned
+    cdef list done
+
+    def __init__(self, list pyfields, filename, int batch_rows, int depth, str strings, batches):
+        self.p = make_batch_parser(pyfields, filename, batch_rows,
+                                   max(batch_rows * (sum(f.len for f in pyfields) + 1), 1 << 16),
+                                   strings)
+        self.file = open(filename, "rb")
+        self.stop = threading.Event()
+        free_chunks = queue.Queue()
+        chunks = queue.Queue(maxsize=2)
+        for _ in range(3):
+            free_chunks.put(bytearray(self.p.cap - self.p.line_len - 2))
+        # `depth` waiting, one being parsed into and one held by the caller
+        self.free_batches = queue.Queue()
+        self.all_batches = [self.p.new_batch() for _ in range(depth + 2)]
+        for batch in self.all_batches:
+            self.free_batches.put(batch)
+
+        self.done = [
+            helper_pool.submit(read_chunks, self.file, free_chunks, chunks, self.stop),
+            helper_pool.submit(parse_chunks, self.p, free_chunks, chunks, self.free_batches,
+                               batches, self.stop)]
+
+    def columns(self, item):
+        # The columns of a (batch, rows) pair, as views of the batch's outputs.
+        cdef AllocationResult batch = item[0]
+        columns = finish_outputs(self.p.fields, self.p.nfields, batch, item[1], False)
+        return list(filter(lambda c: c is not None, columns))
+
+    def release(self, item):
+        # Hands a batch back to the parser once the caller is done with it.
+        self.free_batches.put(item[0])
+
+    def close(self):
+        cdef AllocationResult batch
+        self.stop.set()
+        for done in self.done:
+            done.wait()
+        self.file.close()
+        for batch in self.all_batches:
+            free(batch.ptrs)
+            free(batch.masks)
+        self.all_batches = []
+
+class LoopQueue:
+    """
+    Lets a thread hand items to a coroutine: put() waits for one of `maxsize` free slots, like a
+    bounded queue.Queue, and then schedules the item on `loop`. get() must be awaited on the loop.
+    """
+
+    def __init__(self, loop, maxsize):
+        self.loop = loop
+        self.items = asyncio.Queue()
+        self.slots = threading.Semaphore(maxsize)
+
+    def put(self, item, timeout=None):
+        if not self.slots.acquire(timeout=timeout):
+            raise queue.Full
+        try:
+            self.loop.call_soon_threadsafe(self.items.put_nowait, item)
+        except RuntimeError:
+            # The loop has been closed; nobody is waiting for the item any more
+            pass
+
+    async def get(self):
+        item = await self.items.get()
+        self.slots.release()
+        return item
+
+def run_on_thread(fn, *args, **kwargs):
+    # Calls fn on a thread of helper_pool, returning a future of the running loop that is completed through
+    # the loop once fn returns. Parsing releases the GIL, so the loop keeps running meanwhile.
+    loop = asyncio.get_running_loop()
+    future = loop.create_future()
+
+    def complete(ok, value):
+        if future.cancelled():
+            return
+        if ok:
+            future.set_result(value)
+        else:
+            future.set_exception(value)
+
+    def run():
+        try:
+            value = fn(*args, **kwargs)
+            ok = True
+        except BaseException as e:
+            value = e
+            ok = False
+        try:
+            loop.call_soon_threadsafe(complete, ok, value)
+        except RuntimeError:
+            pass
+
+    helper_pool.submit(run)
+    return future
+
+async def parse_async(list pyfields, filename, **options):
+    """
+
+    The asyncio version of `parse`: the file is read and parsed on a background thread, which
+    doesn't hold the GIL while it reads or parses the numeric fields, so the event loop keeps
+    running in the meantime. Takes the same arguments as `parse`.
+
+    Examples
+    --------
+    >>> from lineparser import parse_async, Field
+    >>> async def main():
+    ...     [a] = await parse_async([Field(float, 12)], "data/small_data.par", threads=4)
+    ...     return a.sum()
+
+    """
+    return await run_on_thread(parse, pyfields, filename, **options)
+
+async def named_parse_async(list named_fields, filename, **options):
+    """
+
+    The asyncio version of `named_parse`; see `parse_async`.
+
+    """
+    return await run_on_thread(named_parse, named_fields, filename, **options)
+
+def iter_batches_async(list pyfields, filename, int batch_rows=65536, int depth=2,
+                       str strings="object"):
+    """
+
+    The asyncio version of `iter_batches`: an asynchronous iterator over the batches of
+    `filename`, which is read and parsed on background threads. Each batch is handed to the event
+    loop as soon as it has been parsed. As with `iter_batches`, the arrays of a batch are reused,
+    so they are only valid until the next batch is requested. Takes the same arguments as
+    `iter_batches`.
+
+    Examples
+    --------
+    >>> from lineparser import iter_batches_async, Field
+    >>> async def main():
+    ...     total = 0
+    ...     async for [a] in iter_batches_async([Field(float, 12)], "data/small_data.par"):
+    ...         total += a.sum()
+    ...     return total
+
+    """
+    if batch_rows < 1:
+        raise ValueError("batch_rows must be at least 1.")
+    if depth < 1:
+        raise ValueError("depth must be at least 1.")
+    return AsyncBatchIterator(pyfields, filename, batch_rows, depth, strings)
+
+class AsyncBatchIterator:
+    """
+    The iterator returned by iter_batches_async. The background threads are started by the first
+    __anext__, on the loop that is running it. If the iterator is dropped without being closed,
+    e.g. after a `break` out of `async for`, the stream is closed on a helper thread once it has
+    been collected.
+    """
+
+    def __init__(self, pyfields, filename, batch_rows, depth, strings):
+        self.args = (pyfields, filename, batch_rows, depth, strings)
+        self.batches = None
+        self.stream = None
+        self.held = None
+        self.done = False
+        self.closer = None
+
+    def __aiter__(self):
+        return self
+
+    async def __anext__(self):
+        if self.done:
+            raise StopAsyncIteration
+        if self.stream is None:
+            pyfields, filename, batch_rows, depth, strings = self.args
+            self.batches = LoopQueue(asyncio.get_running_loop(), depth)
+            self.stream = BatchStream(pyfields, filename, batch_rows, depth, strings, self.batches)
+            self.closer = weakref.finalize(self, helper_pool.submit, self.stream.close)
+        if self.held is not None:
+            self.stream.release(self.held)
+            self.held = None
+
+        item = await self.batches.get()
+        if item is None:
+            await self.aclose()
+            raise StopAsyncIteration
+        if isinstance(item, BaseException):
+            await self.aclose()
+            raise item
+        self.held = item
+        return self.stream.columns(item)
+
+    async def aclose(self):
+        # The threads are waited for on a helper thread, so that the loop keeps running meanwhile
+        self.done = True
+        if self.stream is not None:
+            stream = self.stream
+            self.stream = None
+            self.held = None
+            self.closer.detach()
+            await run_on_thread(stream.close)
+
+cdef class Table:
+    """
+
+    A fixed-width file opened with `open_table`. `records` is a read only structured array over
+    the file's contents, with one `S<length>` member per field; `column` converts a field to the
+    same output `parse` would give for it. The line terminators are checked the first time either
+    of them is used, which raises LineParsingError if the lines aren't all where the stride puts
+    them.
+
+    """
+    cdef CField *fields
+    cdef int nfields
+    cdef int line_len
+    cdef int64_t stride
+    cdef int64_t nlines
+    cdef object map
+    cdef object filename
+    cdef dict columns
+    # Set once every line is known to end with the same terminator
+    cdef bint checked
+    cdef readonly list names
+    # The structured array behind `records`, which is only handed out once the lines are checked
+    cdef object record_view
+
+    def __dealloc__(self):
+        free(self.fields)
+
+    def __len__(self):
+        return self.nlines
+
+    @property
+    def records(self):
+        """
+        The read only structured array over the file, with one `S<length>` member per field.
+        """
+        self.check_lines()
+        return self.record_view
+
+    def column(self, name):
+        """
+        Returns field `name` of every line. The first call for a numeric field parses it with the
+        same kernel `parse` uses (for that field only), and later calls return the same array.
+        String and Bytes fields are returned as the `S<length>` view from `records`, unless they
+        have a `strip` mode, in which case they are copied into a new array stripped.
+
+        Raises
+        ------
+        KeyError
+            If there is no field called `name`, or it is a Phantom field.
+        LineParsingError
+            If one of the values fails to parse, or the lines don't all end with the same
+            terminator.
+        """
+        if name in self.columns:
+            return self.columns[name]
+        if name not in self.names or self.fields[self.names.index(name)].ty == Phantom:
+            raise KeyError(name)
+        cdef int j = self.names.index(name)
+        if self.fields[j].ty in (String, Bytes) and self.fields[j].strip == STRIP_NONE:
+            self.check_lines()
+            return self.record_view[name]
+
+        cdef AllocationResult output_obj = allocate_field_outputs(&self.fields[j], 1, self.nlines)
+        cdef const uint8_t[:] data = self.map if self.nlines > 0 else None
+        cdef int offset = 0, owned = 0
+        cdef FastParseResult pr
+        pr.err = 0
+        for k in range(j):
+            offset += self.fields[k].len
+        if self.nlines > 0:
+            with nogil:
+                pr = parse_columns_strided(<char *> &data[0], data.shape[0], self.stride,
+                                           self.line_len, <const char *> &data[0] + self.line_len,
+                                           self.nlines, &self.fields[j], &offset, &owned, 1,
+                                           output_obj.ptrs, output_obj.masks)
+        free(output_obj.ptrs)
+        free(output_obj.masks)
+        if pr.err == OUT_OF_MEMORY:
+            raise MemoryError()
+        if pr.err == NOT_UNIFORM:
+            raise LineParsingError(BAD_LINE, pr.line_n, None, -1, self.filename)
+        if pr.err != 0:
+            pr.field_index = j
+            raise parse_error(pr, self.fields, self.filename)
+        # parse_columns_strided checked the terminator of every line
+        self.checked = True
+
+        result = finish_outputs(&self.fields[j], 1, output_obj, self.nlines)[0]
+        self.columns[name] = result
+        return result
+
+    cdef int check_lines(self) except -1:
+        # Makes sure every line ends with the terminator of the first one and has none inside it,
+        # the first time `records` or a column is read without being parsed.
+        cdef const uint8_t[:] data = self.map if self.nlines > 0 else None
+        cdef int64_t line_n = -1
+        if self.checked:
+            return 0
+        if self.nlines > 0:
+            with nogil:
+                line_n = irregular_line(<const char *> &data[0], data.shape[0], self.line_len,
+                                        self.stride, self.nlines)
+        if line_n != -1:
+            raise LineParsingError(BAD_LINE, line_n, None, -1, self.filename)
+        self.checked = True
+        return 0
+
+def open_table(list pyfields, filename):
+    """
+
+    Opens a fixed-width file as a `Table` without parsing anything. The file is memory mapped and
+    exposed straight away as a numpy structured array (`Table.records`) with one `S<length>`
+    member per field, so opening a file of any size takes about the same time. Numeric fields are
+    only converted when `Table.column` is called for them, so you only pay for the columns you
+    use. Every line must end with the same terminator; only the first one and the file's size are
+    checked here, and the rest are checked the first time `Table.records` or `Table.column` is
+    used.
+
+    Parameters
+    ----------
+    pyfields : `list` of Field or `list` of NamedField
+        The fields of the file, in order. With `NamedField`s the members of the structured array
+        (and the names for `Table.column`) are the field names, otherwise they are "f0", "f1", ...
+        Phantom fields are left out of the structured array.
+    filename : `str` or `bytes`
+        The path of the fixed-width file.
+
+    Returns
+    -------
+    `Table`
+
+    Raises
+    ------
+    LineParsingError
+        If the size of the file doesn't fit lines of the same length with the terminator of the
+        first one.
+    FieldError
+        If there are zero fields provided, or if the provided fields are not all of type `Field`
+    DuplicateFieldNameError
+        If two or more of the NamedFields have the same name.
+
+    Examples
+    --------
+    >>> from lineparser import open_table, NamedField
+    >>> file = open("test.lines", "w")
+    >>> file.write(" 15 255   dog\\n")
+    14
+    >>> file.write("146  12 horse\\n")
+    14
+    >>> file.close()
+    >>> table = open_table([NamedField("a", int, 3), NamedField("b", int, 4),
+    ...                     NamedField("c", str, 6)], "test.lines")
+    >>> table.records
+    array([(b' 15', b' 255', b'   dog'), (b'146', b'  12', b' horse')],
+          dtype={'names': ['a', 'b', 'c'], 'formats': ['S3', 'S4', 'S6'], 'offsets': [0, 3, 7], 'itemsize': 14})
+    >>> table.column("b")
+    array([255,  12])
+
+    """
+    import mmap
+    if all(type(field) == NamedField for field in pyfields):
+        names = [field.name for field in pyfields]
+        if len(set(names)) != len(names):
+            raise DuplicateFieldNameError(next(n for n in names if names.count(n) > 1))
+        pyfields = [field.field for field in pyfields]
+    else:
+        names = [f"f{i}" for i in range(len(pyfields))]
+
+    cdef Table table = Table()
+    table.fields = make_fields(pyfields, "S")
+    table.nfields = len(pyfields)
+    table.names = names
+    table.filename = filename
+    table.columns = {}
+    table.checked = False
+
+    offsets = []
+    table.line_len = 0
+    for j in range(table.nfields):
+        offsets.append(table.line_len)
+        table.line_len += table.fields[j].len
+
+    with open(encode_path(filename), "rb") as file:
+        size = os.fstat(file.fileno()).st_size
+        table.map = mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ) if size > 0 else b""
+
+    cdef const uint8_t[:] data = table.map
+    cdef int64_t nlines = 0
+    table.stride = table.line_len + 1
+    if size == table.line_len:
+        # A single line without a terminator
+        nlines = 1
+    elif size > 0:
+        # Only the first terminator is looked at, so that opening doesn't touch every page of the
+        # file; Table.column checks the rest.
+        table.stride = uniform_stride(<const char *> &data[0], size, table.line_len, &nlines)
+        if table.stride < 0:
+            raise LineParsingError(BAD_LINE, 0, None, -1, filename)
+    table.nlines = nlines
+
+    keep = [j for j in range(table.nfields) if table.fields[j].ty != Phantom]
+    # The terminator is padding at the end of each record, unless the last line doesn't have one
+    itemsize = table.stride if size == nlines * table.stride else table.line_len
+    dtype = np.dtype({'names': [names[j] for j in keep],
+                      'formats': [f"S{table.fields[j].len}" for j in keep],
+                      'offsets': [offsets[j] for j in keep], 'itemsize': itemsize})
+    table.record_view = np.ndarray(nlines, dtype=dtype, buffer=table.map, strides=(table.stride,))
+    return table
+
+cdef object parse_error(FastParseResult pr, const CField *fields, filename):
+    # The LineParsingError for a parse of `filename` that failed with `pr`.
+    cdef int field_pos = -1
+    field_ty = None
+    if pr.field_index != -1:
+        field_pos = 0
+        field_ty = fields[pr.field_index].ty
+        for i in range(pr.field_index):
+            field_pos += fields[i].len
+    return LineParsingError(pr.err, pr.line_n, field_ty, field_pos, filename, pr.field_index)
+
+cdef int check_read(ReadWholeFileResult file_res, filename) except -1:
+    if file_res.err != 0:
+        if file_res.err == OUT_OF_MEMORY:
+            raise MemoryError("There is not enough memory to read the entire input file.")
+        if file_res.err == FILE_NOT_FOUND:
+            raise Exception(f"Failed to locate file '{filename}'.")
+
+        raise OSError(file_res.err, str(file_res.err))
+    return 0
+
+cdef list finish_outputs(const CField *fields, int nfields, AllocationResult output_obj, int64_t nlines,
+                         bint trim=True):
+    """
+    Trims the outputs allocated by allocate_field_outputs down to the `nlines` rows that were
+    parsed, and gives them their final types. Phantom fields are left as None. With `trim=False`
+    the outputs are left alone and views of their first `nlines` rows are returned instead.
+    """
+    cdef list py_handles = output_obj.py_handles if trim else list(output_obj.py_handles)
+    cdef list mask_handles = output_obj.mask_handles if trim else list(output_obj.mask_handles)
+
+    for i in range(nfields):
+        if fields[i].ty == Phantom or is_view_field(&fields[i]):
+            continue
+        if fields[i].ty == Categorical:
+            py_handles[i] = finish_categorical(py_handles[i], fields[i].len, nlines, trim)
+        elif is_object_field(&fields[i]):
+            if trim:
+                del py_handles[i][nlines:]
+            else:
+                py_handles[i] = py_handles[i][0:nlines]
+        elif fields[i].ty == Bool and fields[i].packed:
+            if trim:
+                py_handles[i].resize((nlines + 7) // 8)
+            else:
+                py_handles[i] = py_handles[i][:(nlines + 7) // 8]
+        else:
+            if trim:
+                py_handles[i].resize(nlines)
+            else:
+                py_handles[i] = py_handles[i][:nlines]
+            if fields[i].ty == Decimal and not fields[i].as_float:
+                py_handles[i] = py_handles[i].view(DecimalArray)
+                py_handles[i].scale = fields[i].scale
+            elif fields[i].ty == Float16:
+                py_handles[i] = py_handles[i].view(np.float16)
+            elif fields[i].ty == DateTime:
+                py_handles[i] = py_handles[i].view(datetime_dtype(&fields[i].layout))
+            if fields[i].nulls == NULLS_MASK:
+                if trim:
+                    mask_handles[i].resize(nlines)
+                else:
+                    mask_handles[i] = mask_handles[i][:nlines]
+                py_handles[i] = np.ma.MaskedArray(py_handles[i], mask=mask_handles[i], copy=False)
+
+    return py_handles
+
+cdef object finish_categorical(CategoryTable table, int width, int64_t nlines, bint trim):
+    # The CategoricalArray for a Categorical field's first `nlines` rows.
+    if table.table.failed:
+        raise MemoryError("There is not enough memory for the categories of a Categorical field.")
+    codes = table.codes
+    if trim:
+        codes.resize(nlines, refcheck=False)
+    else:
+        codes = codes[:nlines]
+    result = codes.view(CategoricalArray)
+    result.categories = np.frombuffer(table.table.values[:table.table.n_unique * width],
+                                      dtype=f"S{width}").copy()
+    return result
+
+class CategoricalArray(np.ndarray):
+    """
+
+    The output of a Categorical field: an int32 numpy array of codes, where code c stands for the
+    field value `categories[c]`. `categories` is an `np.dtype('S<length>')` array that holds each
+    distinct value once, in the order they first appear in the file.
+
+    Examples
+    --------
+    >>> from lineparser import parse, Field, Ty
+    >>> file = open("test.lines", "w")
+    >>> file.write("  J\n  K\n  J\n  Q\n")
+    16
+    >>> file.close()
+    >>> [labels] = parse([Field(Ty.Categorical, 3)], "test.lines")
+    >>> labels
+    CategoricalArray([0, 1, 0, 2], dtype=int32)
+    >>> labels.categories
+    array([b'  J', b'  K', b'  Q'], dtype='|S3')
+    >>> labels.decode()
+    array([b'  J', b'  K', b'  J', b'  Q'], dtype='|S3')
+
+    """
+
+    def __array_finalize__(self, obj):
+        self.categories = getattr(obj, 'categories', None)
+
+    def decode(self):
+        """
+        Returns the field value of every row, as an `np.dtype('S<length>')` array.
+        """
+        return self.categories[self.view(np.ndarray)]
+
+class DecimalArray(np.ndarray):
+    """
+
+    The output of a Decimal field: an int64 numpy array where each element holds a fixed-point
+    value multiplied by 10^`scale`. Keeping the values as integers makes them exact, so they can be
+    compared, summed, and written back out without any rounding.
+
+    Examples
+    --------
+    >>> from lineparser import parse, Field, Ty
+    >>> file = open("test.lines", "w")
+    >>> file.write("   31.43339\n  -41.89467\n")
+    24
+    >>> file.close()
+    >>> [wavenumbers] = parse([Field(Ty.Decimal, 11, scale=5)], "test.lines")
+    >>> wavenumbers
+    DecimalArray([ 3143339, -4189467])
+    >>> wavenumbers.scale
+    5
+    >>> wavenumbers.to_float64()
+    array([ 31.43339, -41.89467])
+
+    """
+
+    def __array_finalize__(self, obj):
+        self.scale = getattr(obj, 'scale', 0)
+
+    def to_float64(self):
+        """
+        Returns a new float64 array holding value * 10^-scale for each element.
+        """
+        return self.view(np.ndarray) / (10.0 ** self.scale)
+
+def bfloat16_to_float32(bits):
+    """
+
+    Widens the output of a BFloat16 field (a `np.uint16` array of bfloat16 bit patterns) to a
+    `np.float32` array. This is exact, since bfloat16 is just a float32 with the low 16 bits of the
+    mantissa dropped.
+
+    Examples
+    --------
+    >>> from lineparser import parse, Field, Ty, bfloat16_to_float32
+    >>> file = open("test.lines", "w")
+    >>> file.write("  1.5\n-0.25\n")
+    12
+    >>> file.close()
+    >>> [bits] = parse([Field(Ty.BFloat16, 5)], "test.lines")
+    >>> bits
+    array([16320, 48768], dtype=uint16)
+    >>> bfloat16_to_float32(bits)
+    array([ 1.5 , -0.25], dtype=float32)
+
+    """
+    return (np.asarray(bits, dtype=np.uint16).astype(np.uint32) << 16).view(np.float32)
+
+cdef extern from "arrow.c" nogil:
+    enum: ARROW_FLAG_NULLABLE
+
+    struct ArrowSchema:
+        const char *format
+        const char *name
+        const char *metadata
+        int64_t flags
+        int64_t n_children
+        ArrowSchema **children
+        ArrowSchema *dictionary
+        void (*release)(ArrowSchema *) noexcept nogil
+        void *private_data
+
+    struct ArrowArray:
+        int64_t length
+        int64_t null_count
+        int64_t offset
+        int64_t n_buffers
+        int64_t n_children
+        const void **buffers
+        ArrowArray **children
+        ArrowArray *dictionary
+        void (*release)(ArrowArray *) noexcept nogil
+        void *private_data
+
+    struct ArrowArrayStream:
+        int (*get_schema)(ArrowArrayStream *, ArrowSchema *) noexcept nogil
+        int (*get_next)(ArrowArrayStream *, ArrowArray *) noexcept nogil
+        const char *(*get_last_error)(ArrowArrayStream *) noexcept nogil
+        void (*release)(ArrowArrayStream *) noexcept nogil
+        void *private_data
+
+    cdef void fixed_width_offsets32(int32_t *offsets, int64_t n, int width)
+    cdef void fixed_width_offsets64(int64_t *offsets, int64_t n, int width)
+    cdef int64_t mask_to_validity(const uint8_t *mask, uint8_t *bitmap, int64_t n)
+    cdef int64_t first_invalid_utf8(const char *data, int64_t n, int width)
+    cdef int64_t unpadded_size(const char *data, int64_t n, int width)
+    cdef void unpad_strings32(const char *data, int64_t n, int width, char *dst, int32_t *offsets)
+    cdef void unpad_strings64(const char *data, int64_t n, int width, char *dst, int64_t *offsets)
+
+cdef inline void *buffer_address(arr):
+    # The address of the data of a contiguous numpy array, or NULL for None.
+    if arr is None:
+        return NULL
+    return <void *> <intptr_t> arr.ctypes.data
+
+cdef class ArrowColumn:
+    """
+
+    One column of an `ArrowTable`. It implements the Arrow PyCapsule interface
+    (`__arrow_c_schema__` and `__arrow_c_array__`), so it can be passed to e.g. `pyarrow.array`
+    or `polars.Series` directly. The Arrow buffers are the numpy arrays `parse` filled in, and they
+    stay alive for as long as the consumer holds on to them.
+
+    """
+    # The field's name in the exported schema
+    cdef public str name
+    # The Arrow format string, e.g. b"l" for int64 or b"u" for utf8
+    cdef readonly bytes format
+    cdef readonly int64_t length
+    cdef readonly int64_t null_count
+    # The Arrow buffers (validity bitmap first) as numpy arrays, with None for absent ones
+    cdef list buffers
+    # The values of a dictionary encoded (Categorical) column, or None
+    cdef ArrowColumn dictionary
+
+    def __len__(self):
+        return self.length
+
+    def __repr__(self):
+        return f"ArrowColumn({repr(self.name)}, {self.format.decode()}, {self.length})"
+
+    def __arrow_c_schema__(self):
+        cdef ArrowSchema *schema = <ArrowSchema *> malloc(sizeof(ArrowSchema))
+        if schema == NULL:
+            raise MemoryError()
+        schema.release = NULL
+        capsule = PyCapsule_New(schema, "arrow_schema", &release_schema_capsule)
+        export_column_schema(self, schema)
+        return capsule
+
+    def __arrow_c_array__(self, requested_schema=None):
+        # requested_schema is ignored: the column can only be exported as its own type
+        cdef ArrowArray *array = <ArrowArray *> malloc(sizeof(ArrowArray))
+        if array == NULL:
+            raise MemoryError()
+        array.release = NULL
+        capsule = PyCapsule_New(array, "arrow_array", &release_array_capsule)
+        export_column_array(self, array)
+        return self.__arrow_c_schema__(), capsule
+
+cdef class ArrowTable:
+    """
+
+    The output of `parse(..., result="arrow")`: one `ArrowColumn` per (non Phantom) field. As a
+    whole it implements the Arrow PyCapsule interface as a struct array with one child per column
+    (`__arrow_c_array__`, i.e. a record batch) and as a stream of that one batch
+    (`__arrow_c_stream__`), so it can be passed straight to `pyarrow.table`, `polars.DataFrame`,
+    `duckdb.sql("select * from t")`, etc. Nothing depends on pyarrow.
+
+    Examples
+    --------
+    >>> from lineparser import parse, Field
+    >>> import pyarrow as pa
+    >>> file = open("test.lines", "w")
+    >>> file.write(" 15 255   dog\\n")
+    14
+    >>> file.write("146  12 horse\\n")
+    14
+    >>> file.close()
+    >>> table = parse([Field(int, 3), Field(int, 4), Field(str, 6)], "test.lines", result="arrow")
+    >>> pa.table(table)
+    pyarrow.Table
+    f0: int64
+    f1: int64
+    f2: string
+    ----
+    f0: [[15,146]]
+    f1: [[255,12]]
+    f2: [["   dog"," horse"]]
+
+    """
+    cdef readonly list columns
+    cdef readonly int64_t num_rows
+
+    @property
+    def names(self):
+        return [(<ArrowColumn> column).name for column in self.columns]
+
+    def column(self, name):
+        """
+        Returns the `ArrowColumn` called `name`.
+        """
+        return self.columns[self.names.index(name)]
+
+    def __len__(self):
+        return self.num_rows
+
+    def __arrow_c_schema__(self):
+        cdef ArrowSchema *schema = <ArrowSchema *> malloc(sizeof(ArrowSchema))
+        if schema == NULL:
+            raise MemoryError()
+        schema.release = NULL
+        capsule = PyCapsule_New(schema, "arrow_schema", &release_schema_capsule)
+        export_table_schema(self, schema)
+        return capsule
+
+    def __arrow_c_array__(self, requested_schema=None):
+        cdef ArrowArray *array = <ArrowArray *> malloc(sizeof(ArrowArray))
+        if array == NULL:
+            raise MemoryError()
+        array.release = NULL
+        capsule = PyCapsule_New(array, "arrow_array", &release_array_capsule)
+        export_table_array(self, array)
+        return self.__arrow_c_schema__(), capsule
+
+    def __arrow_c_stream__(self, requested_schema=None):
+        cdef ArrowArrayStream *stream = <ArrowArrayStream *> malloc(sizeof(ArrowArrayStream))
+        if stream == NULL:
+            raise MemoryError()
+        state = [self, False]
+        Py_INCREF(state)
+        stream.get_schema = stream_get_schema
+        stream.get_next = stream_get_next
+        stream.get_last_error = stream_get_last_error
+        stream.release = stream_release
+        stream.private_data = <void *> state
+        return PyCapsule_New(stream, "arrow_array_stream", &release_stream_capsule)
+
+cdef char *copy_cstr(bytes s) except NULL:
+    cdef char *copy = <char *> malloc(len(s) + 1)
+    if copy == NULL:
+        raise MemoryError()
+    memcpy(copy, <char *> s, len(s) + 1)
+    return copy
+
+cdef int export_column_schema(ArrowColumn column, ArrowSchema *out) except -1:
+    out.format = NULL
+    out.name = NULL
+    out.metadata = NULL
+    out.flags = ARROW_FLAG_NULLABLE
+    out.n_children = 0
+    out.children = NULL
+    out.dictionary = NULL
+    out.private_data = NULL
+    out.release = release_schema
+    out.format = copy_cstr(column.format)
+    out.name = copy_cstr(column.name.encode("utf-8"))
+    if column.dictionary is not None:
+        out.dictionary = <ArrowSchema *> malloc(sizeof(ArrowSchema))
+        if out.dictionary == NULL:
+            raise MemoryError()
+        out.dictionary.release = NULL
+        export_column_schema(column.dictionary, out.dictionary)
+    return 0
+
+cdef int export_table_schema(ArrowTable table, ArrowSchema *out) except -1:
+    cdef int64_t n = len(table.columns)
+    out.format = NULL
+    out.name = NULL
+    out.metadata = NULL
+    out.flags = 0
+    out.n_children = 0
+    out.children = NULL
+    out.dictionary = NULL
+    out.private_data = NULL
+    out.release = release_schema
+    out.format = copy_cstr(b"+s")
+    out.name = copy_cstr(b"")
+    out.children = <ArrowSchema **> malloc(sizeof(ArrowSchema *) * max(n, 1))
+    if out.children == NULL:
+        raise MemoryError()
+    for i in range(n):
+        out.children[i] = <ArrowSchema *> malloc(sizeof(ArrowSchema))
+        if out.children[i] == NULL:
+            raise MemoryError()
+        out.children[i].release = NULL
+        out.n_children += 1
+        export_column_schema(table.columns[i], out.children[i])
+    return 0
+
+cdef void release_schema(ArrowSchema *schema) noexcept nogil:
+    free(<void *> schema.format)
+    free(<void *> schema.name)
+    for i in range(schema.n_children):
+        if schema.children[i].release != NULL:
+            schema.children[i].release(schema.children[i])
+        free(schema.children[i])
+    free(schema.children)
+    if schema.dictionary != NULL:
+        if schema.dictionary.release != NULL:
+            schema.dictionary.release(schema.dictionary)
+        free(schema.dictionary)
+    schema.release = NULL
+
+cdef int export_column_array(ArrowColumn column, ArrowArray *out) except -1:
+    # The buffers are borrowed from the column, which is kept alive until the array is released.
+    out.length = column.length
+    out.null_count = column.null_count
+    out.offset = 0
+    out.n_buffers = len(column.buffers)
+    out.n_children = 0
+    out.buffers = NULL
+    out.children = NULL
+    out.dictionary = NULL
+    out.private_data = NULL
+    out.release = release_array
+    out.buffers = <const void **> malloc(sizeof(void *) * out.n_buffers)
+    if out.buffers == NULL:
+        raise MemoryError()
+    for i in range(out.n_buffers):
+        out.buffers[i] = buffer_address(column.buffers[i])
+    Py_INCREF(column)
+    out.private_data = <void *> column
+    if column.dictionary is not None:
+        out.dictionary = <ArrowArray *> malloc(sizeof(ArrowArray))
+        if out.dictionary == NULL:
+            raise MemoryError()
+        out.dictionary.release = NULL
+        export_column_array(column.dictionary, out.dictionary)
+    return 0
+
+cdef int export_table_array(ArrowTable table, ArrowArray *out) except -1:
+    cdef int64_t n = len(table.columns)
+    out.length = table.num_rows
+    out.null_count = 0
+    out.offset = 0
+    out.n_buffers = 1
+    out.n_children = 0
+    out.buffers = NULL
+    out.children = NULL
+    out.dictionary = NULL
+    out.private_data = NULL
+    out.release = release_array
+    out.buffers = <const void **> malloc(sizeof(void *))
+    out.children = <ArrowArray **> malloc(sizeof(ArrowArray *) * max(n, 1))
+    if out.buffers == NULL or out.children == NULL:
+        raise MemoryError()
+    out.buffers[0] = NULL
+    for i in range(n):
+        out.children[i] = <ArrowArray *> malloc(sizeof(ArrowArray))
+        if out.children[i] == NULL:
+            raise MemoryError()
+        out.children[i].release = NULL
+        out.n_children += 1
+        export_column_array(table.columns[i], out.children[i])
+    return 0
+
+cdef void release_array(ArrowArray *array) noexcept with gil:
+    for i in range(array.n_children):
+        if array.children[i].release != NULL:
+            array.children[i].release(array.children[i])
+        free(array.children[i])
+    free(array.children)
+    if array.dictionary != NULL:
+        if array.dictionary.release != NULL:
+            array.dictionary.release(array.dictionary)
+        free(array.dictionary)
+    free(array.buffers)
+    if array.private_data != NULL:
+        Py_DECREF(<object> array.private_data)
+    array.release = NULL
+
+cdef void release_schema_capsule(object capsule) noexcept:
+    cdef ArrowSchema *schema = <ArrowSchema *> PyCapsule_GetPointer(capsule, "arrow_schema")
+    if schema.release != NULL:
+        schema.release(schema)
+    free(schema)
+
+cdef void release_array_capsule(object capsule) noexcept:
+    cdef ArrowArray *array = <ArrowArray *> PyCapsule_GetPointer(capsule, "arrow_array")
+    if array.release != NULL:
+        array.release(array)
+    free(array)
+
+cdef void release_stream_capsule(object capsule) noexcept:
+    cdef ArrowArrayStream *stream = <ArrowArrayStream *> PyCapsule_GetPointer(capsule, "arrow_array_stream")
+    if stream.release != NULL:
+        stream.release(stream)
+    free(stream)
+
+# The stream callbacks. private_data is a list of the table and whether its batch has been sent.
+
+cdef int stream_get_schema(ArrowArrayStream *stream, ArrowSchema *out) noexcept with gil:
+    state = <list> stream.private_data
+    out.release = NULL
+    try:
+        export_table_schema(state[0], out)
+    except MemoryError:
+        if out.release != NULL:
+            out.release(out)
+        return ENOMEM
+    return 0
+
+cdef int stream_get_next(ArrowArrayStream *stream, ArrowArray *out) noexcept with gil:
+    state = <list> stream.private_data
+    out.release = NULL
+    if state[1]:
+        # A released array marks the end of the stream
+        return 0
+    try:
+        export_table_array(state[0], out)
+    except MemoryError:
+        if out.release != NULL:
+            out.release(out)
+        return ENOMEM
+    state[1] = True
+    return 0
+
+cdef const char *stream_get_last_error(ArrowArrayStream *stream) noexcept nogil:
+    return NULL
+
+cdef void stream_release(ArrowArrayStream *stream) noexcept with gil:
+    Py_DECREF(<object> stream.private_data)
+    stream.release = NULL
+
+cdef ArrowColumn arrow_column(field, int field_index, int field_pos, values, int64_t n, str name,
+                              filename):
+    """
+    Wraps the output `parse` produced for `field` (with strings="S") as an Arrow column. Most
+    outputs already have the memory layout of an Arrow type and are used as they are; the rest
+    (unpacked Bools, BFloat16, Decimal, date only DateTime fields) are converted to the nearest
+    one. `n` is the number of rows.
+    """
+    cdef ArrowColumn column = ArrowColumn()
+    cdef int64_t bad
+    validity = None
+    column.name = name
+    column.length = n
+    column.null_count = 0
+    if isinstance(values, np.ma.MaskedArray):
+        mask = np.ascontiguousarray(np.ma.getmaskarray(values))
+        values = values.data
+        validity = np.empty((n + 7) // 8, dtype=np.uint8)
+        column.null_count = mask_to_validity(<const uint8_t *> buffer_address(mask),
+                                             <uint8_t *> buffer_address(validity), n)
+        if column.null_count == 0:
+            validity = None
+    categories = getattr(values, 'categories', None)
+    values = np.ascontiguousarray(values.view(np.ndarray) if type(values) == DecimalArray else values)
+
+    ty = field.ty
+    if ty in (String, Bytes):
+        if ty == String:
+            bad = first_invalid_utf8(<const char *> buffer_address(values), n, field.len)
+            if bad != -1:
+                raise LineParsingError(PARSE_ERROR, bad, ty, field_pos, filename, field_index)
+        column.format = string_buffers(column, validity, values, n, field.len, ty == String,
+                                       field.strip != STRIP_NONE)
+        return column
+
+    if ty == Categorical:
+        # int32 indices into a dictionary of utf8 values
+        categories = np.ascontiguousarray(categories)
+        bad = first_invalid_utf8(<const char *> buffer_address(categories), len(categories), field.len)
+        if bad != -1:
+            bad = int(np.argmax(values == bad))
+            raise LineParsingError(PARSE_ERROR, bad, ty, field_pos, filename, field_index)
+        column.dictionary = ArrowColumn()
+        column.dictionary.name = ""
+        column.dictionary.length = len(categories)
+        column.dictionary.null_count = 0
+        column.dictionary.format = string_buffers(column.dictionary, None, categories,
+                                                  len(categories), field.len, True,
+                                                  field.strip != STRIP_NONE)
+        column.format = b"i"
+    elif ty == Bool:
+        column.format = b"b"
+        if not field.packed:
+            values = np.packbits(values, bitorder='little')
+    elif ty == Decimal and not field.as_float:
+        # decimal128, as the two's complement low and high words of each value
+        column.format = f"d:{max(min(field.len, 38), field.scale)},{field.scale}".encode()
+        values = np.stack([values, values >> 63], axis=1)
+    elif ty == BFloat16:
+        column.format = b"f"
+        values = bfloat16_to_float32(values)
+    elif ty == DateTime:
+        unit = np.datetime_data(values.dtype)[0]
+        if unit == 'D':
+            column.format = b"tdD"
+            values = values.view(np.int64).astype(np.int32)
+        else:
+            kind = "ts" if values.dtype.kind == 'M' else "tD"
+            column.format = f"{kind}{unit[0]}{':' if kind == 'ts' else ''}".encode()
+    else:
+        column.format = {'f8': b"g", 'f4': b"f", 'f2': b"e", 'i8': b"l", 'i4': b"i", 'i2': b"s",
+                         'i1': b"c", 'u8': b"L", 'u4': b"I", 'u2': b"S", 'u1': b"C"}[values.dtype.str[1:]]
+    column.buffers = [validity, values]
+    return column
+
+cdef bytes string_buffers(ArrowColumn column, validity, values, int64_t n, int width, bint utf8,
+                          bint unpad):
+    """
+    Sets the buffers of a string column from an S<width> array and returns its format. The memory
+    of the array is already laid out like Arrow string data, so it is used as it is, unless
+    `unpad` is set (for stripped fields): then the strings are copied without their zero padding.
+    """
+    cdef const char *src = <const char *> buffer_address(values)
+    size = unpadded_size(src, n, width) if unpad else n * width
+    large = size >= (1 << 31)
+    offsets = np.empty(n + 1, dtype=np.int64 if large else np.int32)
+    if unpad:
+        data = np.empty(size, dtype=np.uint8)
+        if large:
+            unpad_strings64(src, n, width, <char *> buffer_address(data), <int64_t *> buffer_address(offsets))
+        else:
+            unpad_strings32(src, n, width, <char *> buffer_address(data), <int32_t *> buffer_address(offsets))
+        values = data
+    elif large:
+        fixed_width_offsets64(<int64_t *> buffer_address(offsets), n, width)
+    else:
+        fixed_width_offsets32(<int32_t *> buffer_address(offsets), n, width)
+    column.buffers = [validity, offsets, values]
+    return (b"U" if large else b"u") if utf8 else (b"Z" if large else b"z")
+
+cdef ArrowTable arrow_table(list pyfields, list outputs, int64_t nlines, filename):
+    # Builds the ArrowTable for parse(..., result="arrow") from its (Phantom free) outputs.
+    cdef ArrowTable table = ArrowTable()
+    table.columns = []
+    table.num_rows = nlines
+    field_pos = 0
+    k = 0
+    for j, field in enumerate(pyfields):
+        if field.ty != Phantom:
+            table.columns.append(arrow_column(field, j, field_pos, outputs[k], nlines, f"f{j}",
+                                              filename))
+            k += 1
+        field_pos += field.len
+    return table
+
+class DuplicateFieldNameError(Exception):
+
+    def __init__(self, name):
+        self.name = name
+
+    def __str__(self):
+        return f"Duplicate field name '{self.name}'."
+
+
+def named_parse(list named_fields, filename, **options):
     """
 
     Attempts to parse the lines from `filename` using the field specfications supplied in
@@ -599,13 +4308,18 @@ def named_parse(list named_fields, filename):
     filename : `str` or `bytes`
         The filename or path which points to the fixed-width formatted file. If filename is a `str`,
         it must be utf-8 encoded
+    **options
+        Passed on to `parse`, e.g. `threads`.
 
     Returns
     -------
     `list` of iterable
         A map from name to the result of parsing, where the parsing results are either a list or
         a numpy array. For String fields it will be a `list` of `str`, and for Float64 and Int64 it
-        will be a numpy array.
+        will be a numpy array. With `result="arrow"`, the `ArrowTable` from `parse` with its
+        columns named after the fields instead, with `result="records"` the structured array
+        with its fields named after them, and with `out` (whose arrays may be keyed by name), the
+        number of lines parsed.
 
     Raises
     ------
@@ -648,7 +4362,25 @@ def named_parse(list named_fields, filename):
 
     fields = list(map(lambda named_field: named_field.field, named_fields))
 
-    parsed = parse(fields, filename)
+    out = options.get("out")
+    if type(out) == dict:
+        # The arrays in out are keyed by name here, and by index in parse
+        index = {named_field.name: i for (i, named_field) in enumerate(named_fields)}
+        options["out"] = {index.get(key, key): arr for (key, arr) in out.items()}
+
+    parsed = parse(fields, filename, **options)
+
+    if out is not None:
+        return parsed
+    if type(parsed) == np.ndarray:
+        parsed.dtype.names = tuple(f.name for f in named_fields if f.field.ty != Phantom)
+        return parsed
+    if type(parsed) == ArrowTable:
+        columns = (<ArrowTable> parsed).columns
+        named = [f for f in named_fields if f.field.ty != Phantom]
+        for (named_field, column) in zip(named, columns):
+            (<ArrowColumn> column).name = named_field.name
+        return parsed
 
     named_result = {}
 
@@ -671,6 +4403,8 @@ class NamedField:
         literals 'int', 'float', and 'str'.
     length : int
         The length of the field. This must be a positive integer.
+    **options
+        Any type specific options accepted by `Field`, e.g. `scale` for Decimal fields.
     
     Examples
     --------
@@ -693,8 +4427,8 @@ class NamedField:
 
     """
 
-    def __init__(self, name, ty, length):
-        self.field = Field(ty, length)
+    def __init__(self, name, ty, length, **options):
+        self.field = Field(ty, length, **options)
         self.name = self.__check_name(name)
 
     def __check_name(self, name):
@@ -703,19 +4437,45 @@ class NamedField:
         return name
 
     def __str__(self):
-        return f"NamedField({repr(self.name)}, {ty_to_str(self.field.ty)}, {self.field.len})"
+        return f"NamedField({repr(self.name)}, {self.field._ty_str()}, {self.field.len})"
 
     def __repr__(self):
         return str(self)
 
 
 
+cdef object numpy_dtype(int ty):
+    # The numpy dtype of the integer and float field types.
+    return {Float64: np.float64, Float32: np.float32, Int64: np.int64, Int32: np.int32,
+            Int16: np.int16, Int8: np.int8, UInt64: np.uint64, UInt32: np.uint32,
+            UInt16: np.uint16, UInt8: np.uint8}[ty]
+
+cdef class CategoryTable:
+    # The output of a Categorical field while it is being parsed: the codes array, and the
+    # CatTable that fills it in (which is what the field's output pointer points to).
+    cdef CatTable table
+    cdef object codes
+
+    def __dealloc__(self):
+        cat_free(&self.table)
+
+cdef CategoryTable category_table(codes, int width):
+    cdef CategoryTable table = CategoryTable()
+    cdef int32_t[:] cptr = codes
+    table.codes = codes
+    if cat_init(&table.table, &cptr[0] if len(codes) > 0 else NULL, width) != 0:
+        raise MemoryError()
+    return table
+
 cdef class AllocationResult:
     cdef void **ptrs
     cdef object py_handles
+    # Mask arrays for fields with nulls='mask' (NULL / None for every other field)
+    cdef uint8_t **masks
+    cdef object mask_handles
 
 
-cdef AllocationResult allocate_field_outputs(const CField *fields, int nfields, int64_t nlines):
+cdef AllocationResult allocate_field_outputs(const CField *fields, int nfields, int64_t nlines, bint zero=True):
     """
     Allocates output based on the field specifications. The only data type that doesn't get an
     an array for output is string, since c strings don't mix with python very well; so to minimize
@@ -723,10 +4483,14 @@ cdef AllocationResult allocate_field_outputs(const CField *fields, int nfields,
 
     :return: [] if any of the fields have an invalid type, otherwise returns
     [py_handles, <ptrs>] where py_handles contains python objects which contain the output data,
-    and <ptrs> is a c array of pointers to the output containers
+    and <ptrs> is a c array of pointers to the output containers. With `zero=False` the arrays are
+    left uninitialized, for callers that first-touch them from the threads that will parse them.
     """
+    alloc = np.zeros if zero else np.empty
     cdef list py_handles = []
+    cdef list mask_handles = []
     cdef void **ptrs = <void**> malloc(sizeof(void*) * nfields)
+    cdef uint8_t **masks = <uint8_t **> malloc(sizeof(uint8_t *) * nfields)
     cdef int i = 0
     cdef double[:] dptr
     cdef float[:] fptr
@@ -734,57 +4498,115 @@ cdef AllocationResult allocate_field_outputs(const CField *fields, int nfields,
     cdef int32_t[:] iptr
     cdef int16_t[:] sptr
     cdef int8_t[:] bptr
+    cdef uint64_t[:] ulptr
+    cdef uint32_t[:] uiptr
+    cdef uint16_t[:] usptr
+    cdef uint8_t[:] ubptr
     cdef CTy ty
     while i < nfields:
         ty = fields[i].ty
-        if ty == Float64:
-            arr = np.zeros(nlines, dtype=np.float64)
+        if ty == Float64 or (ty == Decimal and fields[i].as_float):
+            arr = alloc(nlines, dtype=np.float64)
             py_handles.append(arr)
             dptr = arr
             ptrs[i] = <void *> &dptr[0]
         elif ty == Float32:
-            arr = np.zeros(nlines, dtype=np.float32)
+            arr = alloc(nlines, dtype=np.float32)
             py_handles.append(arr)
             fptr = arr
             ptrs[i] = <void *> &fptr[0]
-        elif ty == Int64:
-            arr = np.zeros(nlines, dtype=np.int64)
+        elif ty in (Int64, DateTime) or (ty == Decimal and not fields[i].as_float):
+            arr = alloc(nlines, dtype=np.int64)
             py_handles.append(arr)
             lptr = arr
             ptrs[i] = <void *> &lptr[0]
         elif ty == Int32:
-            arr = np.zeros(nlines, dtype=np.int32)
+            arr = alloc(nlines, dtype=np.int32)
             py_handles.append(arr)
             iptr = arr
             ptrs[i] = <void *> &iptr[0]
         elif ty == Int16:
-            arr = np.zeros(nlines, dtype=np.int16)
+            arr = alloc(nlines, dtype=np.int16)
             py_handles.append(arr)
             sptr = arr
             ptrs[i] = <void *> &sptr[0]
         elif ty == Int8:
-            arr = np.zeros(nlines, dtype=np.int8)
+            arr = alloc(nlines, dtype=np.int8)
             py_handles.append(arr)
             bptr = arr
             ptrs[i] = <void *> &bptr[0]
+        elif ty == UInt64:
+            arr = alloc(nlines, dtype=np.uint64)
+            py_handles.append(arr)
+            ulptr = arr
+            ptrs[i] = <void *> &ulptr[0]
+        elif ty == UInt32:
+            arr = alloc(nlines, dtype=np.uint32)
+            py_handles.append(arr)
+            uiptr = arr
+            ptrs[i] = <void *> &uiptr[0]
+        elif ty in (UInt16, Float16, BFloat16):
+            arr = alloc(nlines, dtype=np.uint16)
+            py_handles.append(arr)
+            usptr = arr
+            ptrs[i] = <void *> &usptr[0]
+        elif ty == UInt8 or (ty == Bool and fields[i].packed):
+            arr = alloc(nlines if ty == UInt8 else (nlines + 7) // 8, dtype=np.uint8)
+            py_handles.append(arr)
+            ubptr = arr
+            ptrs[i] = <void *> &ubptr[0]
+        elif ty == Bool:
+            arr = alloc(nlines, dtype=np.bool_)
+            py_handles.append(arr)
+            ubptr = arr.view(np.uint8)
+            ptrs[i] = <void *> &ubptr[0]
+        elif is_view_field(&fields[i]):
+            # Filled in by view_string_fields once the file has been parsed
+            arr = None
+            py_handles.append(None)
+            ptrs[i] = NULL
+        elif ty in (String, Bytes) and fields[i].strings != STRINGS_OBJECT:
+            kind = "U" if ty == String and fields[i].strings == STRINGS_U else "S"
+            arr = alloc(nlines, dtype=f"{kind}{fields[i].len}")
+            py_handles.append(arr)
+            ubptr = arr.view(np.uint8)
+            ptrs[i] = <void *> &ubptr[0]
         elif ty in (String, Bytes):
             arr = list()
             py_handles.append(arr)
             ptrs[i] = <void *> arr
+        elif ty == Categorical:
+            table = category_table(alloc(nlines, dtype=np.int32), fields[i].len)
+            py_handles.append(table)
+            ptrs[i] = <void *> &(<CategoryTable> table).table
         elif ty == Phantom:
             arr = None
             py_handles.append(None)
             ptrs[i] = NULL
         else:
             free(ptrs)
+            free(masks)
             ar = AllocationResult()
             ar.ptrs = NULL
             ar.py_handles = None
+            ar.masks = NULL
+            ar.mask_handles = None
             return ar
+
+        if fields[i].nulls == NULLS_MASK:
+            arr = alloc(nlines, dtype=np.bool_)
+            mask_handles.append(arr)
+            ubptr = arr.view(np.uint8)
+            masks[i] = &ubptr[0]
+        else:
+            mask_handles.append(None)
+            masks[i] = NULL
         i += 1
 
     ar = AllocationResult()
     ar.ptrs = ptrs
     ar.py_handles = py_handles
+    ar.masks = masks
+    ar.mask_handles = mask_handles
 
     return ar
@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <stdint.h>
+#include <string.h>
 
 #define MAKE_PARSER(ty, parse_expr, output, str, line_n, field_len) \
     int prev = errno; \
@@ -29,18 +30,727 @@ inline int parse_f32(void *output, char *str, int64_t line_n, int field_len) {
     MAKE_PARSER(float, strtod(str, &endptr), output, str, line_n, field_len)
 }
 
-inline int parse_i64(void *output, char *str, int64_t line_n, int field_len) {
-    MAKE_PARSER(int64_t, strtol(str, &endptr, 10), output, str, line_n, field_len)
+/*
+ * SWAR helpers: treat 8 ASCII bytes as one little-endian 64 bit word so that 8 digits can be
+ * validated and converted with a handful of integer ops instead of 8 dependent multiply-adds.
+ * On big-endian targets LP_SWAR is 0 and the scalar loops below do all of the work.
+ */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define LP_SWAR 0
+#else
+#define LP_SWAR 1
+#endif
+
+static inline uint64_t swar_load8(const char *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+// Non-zero if all 8 bytes of v are ASCII digits.
+static inline int swar_is_8digits(uint64_t v) {
+    return (((v & 0xF0F0F0F0F0F0F0F0ULL) |
+             (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+            == 0x3333333333333333ULL);
+}
+
+// Converts 8 ASCII digits (first digit in the lowest byte) to their integer value.
+static inline uint32_t swar_parse_8digits(uint64_t v) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 100 + (1000000ULL << 32);
+    const uint64_t mul2 = 1 + (10000ULL << 32);
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t) v;
+}
+
+static const uint64_t POW10_U64[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+    1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+    1000000000000000000ULL, 10000000000000000000ULL
+};
+
+// Powers of ten up to 1e22 are exact in a double, so dividing by one of these rounds correctly.
+static const double POW10_F64[19] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+    1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18
+};
+
+static inline int is_field_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == 0;
+}
+
+/*
+ * Accumulates the run of digits starting at *pp (and ending before end) into *acc, 8 at a time
+ * when possible. Returns the number of digits consumed, or -1 if *acc would exceed limit.
+ */
+static inline int accumulate_digits(const char **pp, const char *end, uint64_t *acc, uint64_t limit) {
+    const char *p = *pp;
+    uint64_t a = *acc;
+    int n = 0;
+#if LP_SWAR
+    while (end - p >= 8) {
+        uint64_t v = swar_load8(p);
+        if (!swar_is_8digits(v))
+            break;
+        uint32_t x = swar_parse_8digits(v);
+        if (a > (limit - x) / 100000000ULL)
+            return -1;
+        a = a * 100000000ULL + x;
+        p += 8;
+        n += 8;
+    }
+#endif
+    while (p < end && *p >= '0' && *p <= '9') {
+        uint64_t d = (uint64_t) (*p - '0');
+        if (a > (limit - d) / 10)
+            return -1;
+        a = a * 10 + d;
+        p++;
+        n++;
+    }
+    *pp = p;
+    *acc = a;
+    return n;
+}
+
+/*
+ * Parses a fixed-point number such as "  -31.43339" into the integer value * 10^scale without
+ * any floating point operations. Fractional digits past `scale` are only accepted if they are
+ * zero, so the result is always exact. A blank field is 0, like the other numeric parsers.
+ */
+static inline int parse_scaled(const char *str, int field_len, int scale, int64_t *out) {
+    const char *p = str;
+    const char *end = str + field_len;
+    uint64_t acc = 0;
+    int sign = 0, neg = 0, dot = 0, nint = 0, nfrac = 0, n;
+
+    while (p < end && *p == ' ')
+        p++;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        sign = 1;
+        neg = *p == '-';
+        p++;
+    }
+
+    uint64_t limit = (uint64_t) INT64_MAX + (uint64_t) neg;
+
+    if ((nint = accumulate_digits(&p, end, &acc, limit)) < 0)
+        return 1;
+
+    if (p < end && *p == '.') {
+        const char *frac_end;
+        dot = 1;
+        p++;
+        frac_end = end - p > scale ? p + scale : end;
+        if ((nfrac = accumulate_digits(&p, frac_end, &acc, limit)) < 0)
+            return 1;
+        // Extra precision is fine as long as it doesn't change the value.
+        while (p < end && *p == '0')
+            p++;
+    }
+
+    if (nint + nfrac == 0) {
+        // Blank field; a lone sign or decimal point is an error.
+        while (p < end && is_field_space(*p))
+            p++;
+        if (p != end || sign || dot)
+            return 1;
+        *out = 0;
+        return 0;
+    }
+
+    while (p < end) {
+        if (!is_field_space(*p))
+            return 1;
+        p++;
+    }
+
+    n = scale - nfrac;
+    if (n > 0) {
+        if (acc > limit / POW10_U64[n])
+            return 1;
+        acc *= POW10_U64[n];
+    }
+
+    *out = neg ? (int64_t) (0 - acc) : (int64_t) acc;
+    return 0;
+}
+
+static inline int parse_decimal(void *output, char *str, int64_t line_n, int field_len, int scale) {
+    return parse_scaled(str, field_len, scale, &((int64_t *) output)[line_n]);
+}
+
+// Fused Decimal -> Float64 conversion: the exact scaled integer divided by an exact power of ten.
+static inline int parse_decimal_f64(void *output, char *str, int64_t line_n, int field_len, int scale) {
+    int64_t v;
+    if (parse_scaled(str, field_len, scale, &v))
+        return 1;
+    ((double *) output)[line_n] = (double) v / POW10_F64[scale];
+    return 0;
+}
+
+/*
+ * Parses a base 10 integer and checks that it lies within [min, max]. The range check is folded
+ * into the overflow check done while accumulating digits, so narrowing types cost nothing extra.
+ * Like strtol, leading spaces and a sign are accepted and a blank field is 0.
+ */
+static inline int parse_int_range(const char *str, int field_len, int64_t min, int64_t max, int64_t *out) {
+    const char *p = str;
+    const char *end = str + field_len;
+    uint64_t acc = 0, limit;
+    int sign = 0, neg = 0, n;
+
+    while (p < end && *p == ' ')
+        p++;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        sign = 1;
+        neg = *p == '-';
+        p++;
+    }
+
+    limit = neg ? (uint64_t) (-(min + 1)) + 1 : (uint64_t) max;
+
+    if ((n = accumulate_digits(&p, end, &acc, limit)) < 0)
+        return 1;
+
+    if (n == 0) {
+        if (sign)
+            return 1;
+        while (p < end && is_field_space(*p))
+            p++;
+        if (p != end)
+            return 1;
+        *out = 0;
+        return 0;
+    }
+
+    if (p < end && !is_field_space(*p))
+        return 1;
+
+    *out = neg ? (int64_t) (0 - acc) : (int64_t) acc;
+    return 0;
+}
+
+#define MAKE_INT_PARSER(ty, min, max, output, str, line_n, field_len) \
+    int64_t v; \
+    if (parse_int_range(str, field_len, min, max, &v)) \
+        return 1; \
+    ((ty *) output)[line_n] = (ty) v; \
+    return 0;
+
+static inline int parse_i64(void *output, char *str, int64_t line_n, int field_len) {
+    MAKE_INT_PARSER(int64_t, INT64_MIN, INT64_MAX, output, str, line_n, field_len)
+}
+
+static inline int parse_i32(void *output, char *str, int64_t line_n, int field_len) {
+    MAKE_INT_PARSER(int32_t, INT32_MIN, INT32_MAX, output, str, line_n, field_len)
+}
+
+static inline int parse_i16(void *output, char *str, int64_t line_n, int field_len) {
+    MAKE_INT_PARSER(int16_t, INT16_MIN, INT16_MAX, output, str, line_n, field_len)
+}
+
+static inline int parse_i8(void *output, char *str, int64_t line_n, int field_len) {
+    MAKE_INT_PARSER(int8_t, INT8_MIN, INT8_MAX, output, str, line_n, field_len)
+}
+
+/*
+ * Unsigned counterpart of parse_int_range: a '+' is accepted, but a '-' is always an error
+ * (even for "-0"), so no negative value can wrap around into a huge unsigned one.
+ */
+static inline int parse_uint_range(const char *str, int field_len, uint64_t max, uint64_t *out) {
+    const char *p = str;
+    const char *end = str + field_len;
+    uint64_t acc = 0;
+    int sign = 0, n;
+
+    while (p < end && *p == ' ')
+        p++;
+
+    if (p < end && *p == '+') {
+        sign = 1;
+        p++;
+    }
+
+    if ((n = accumulate_digits(&p, end, &acc, max)) < 0)
+        return 1;
+
+    if (n == 0) {
+        if (sign)
+            return 1;
+        while (p < end && is_field_space(*p))
+            p++;
+        if (p != end)
+            return 1;
+        *out = 0;
+        return 0;
+    }
+
+    if (p < end && !is_field_space(*p))
+        return 1;
+
+    *out = acc;
+    return 0;
+}
+
+#define MAKE_UINT_PARSER(ty, max, output, str, line_n, field_len) \
+    uint64_t v; \
+    if (parse_uint_range(str, field_len, max, &v)) \
+        return 1; \
+    ((ty *) output)[line_n] = (ty) v; \
+    return 0;
+
+static inline int parse_u64(void *output, char *str, int64_t line_n, int field_len) {
+    MAKE_UINT_PARSER(uint64_t, UINT64_MAX, output, str, line_n, field_len)
+}
+
+static inline int parse_u32(void *output, char *str, int64_t line_n, int field_len) {
+    MAKE_UINT_PARSER(uint32_t, UINT32_MAX, output, str, line_n, field_len)
+}
+
+static inline int parse_u16(void *output, char *str, int64_t line_n, int field_len) {
+    MAKE_UINT_PARSER(uint16_t, UINT16_MAX, output, str, line_n, field_len)
+}
+
+static inline int parse_u8(void *output, char *str, int64_t line_n, int field_len) {
+    MAKE_UINT_PARSER(uint8_t, UINT8_MAX, output, str, line_n, field_len)
+}
+
+/*
+ * Rounds a double to the nearest (ties to even) binary float with `exp_bits` exponent bits and
+ * `mant_bits` mantissa bits, returning its bit pattern: IEEE half for (5, 10) and bfloat16 for
+ * (8, 7). Overflow becomes infinity and values too small for the smallest subnormal become zero.
+ *
+ * Rounding the (correctly rounded) strtod result again can only differ from rounding the decimal
+ * string directly if the string lies within one double ulp of a rounding midpoint, so for real
+ * data this is the correctly rounded value.
+ */
+static inline uint16_t f64_to_small_float(double d, int exp_bits, int mant_bits) {
+    uint64_t b, sig, rem, halfway, r;
+    int exp, e, shift;
+    const int max_e = (1 << exp_bits) - 1;
+    const int bias = (1 << (exp_bits - 1)) - 1;
+    uint16_t sign;
+
+    memcpy(&b, &d, 8);
+    sign = (uint16_t) ((b >> 48) & 0x8000);
+    exp = (int) ((b >> 52) & 0x7FF);
+    sig = b & 0xFFFFFFFFFFFFFULL;
+
+    if (exp == 0x7FF)
+        return sign | (uint16_t) (max_e << mant_bits) | (sig ? (uint16_t) (1 << (mant_bits - 1)) : 0);
+
+    // Double subnormals are far below the smallest subnormal of either target.
+    if (exp == 0)
+        return sign;
+
+    e = exp - 1023 + bias;
+    if (e >= max_e)
+        return sign | (uint16_t) (max_e << mant_bits);
+
+    if (e > 0) {
+        shift = 52 - mant_bits;
+        r = ((uint64_t) e << mant_bits) | (sig >> shift);
+    } else {
+        shift = 52 - mant_bits + 1 - e;
+        if (shift > 53)
+            return sign;
+        sig |= 1ULL << 52;
+        r = sig >> shift;
+    }
+
+    rem = sig & ((1ULL << shift) - 1);
+    halfway = 1ULL << (shift - 1);
+    // A carry out of the mantissa correctly bumps the exponent (or overflows to infinity).
+    if (rem > halfway || (rem == halfway && (r & 1)))
+        r++;
+
+    return sign | (uint16_t) r;
+}
+
+static inline int parse_f16(void *output, char *str, int64_t line_n, int field_len) {
+    MAKE_PARSER(uint16_t, f64_to_small_float(strtod(str, &endptr), 5, 10), output, str, line_n, field_len)
+}
+
+static inline int parse_bf16(void *output, char *str, int64_t line_n, int field_len) {
+    MAKE_PARSER(uint16_t, f64_to_small_float(strtod(str, &endptr), 8, 7), output, str, line_n, field_len)
+}
+
+static inline int char_in_set(const uint64_t *set, unsigned char c) {
+    return (int) ((set[c >> 6] >> (c & 63)) & 1);
+}
+
+/*
+ * Parses a one character flag: the field is true if its only non-blank character is in
+ * `true_set`, and false if it is blank or anything else. If `false_set` is non-empty, characters
+ * in neither set are an error. Sets are 256 bit membership masks indexed by byte value.
+ */
+static inline int parse_flag(const char *str, int field_len, const uint64_t *true_set,
+                             const uint64_t *false_set, int *out) {
+    const char *p = str;
+    const char *end = str + field_len;
+    unsigned char c;
+
+    while (p < end && *p == ' ')
+        p++;
+
+    if (p == end || *p == 0) {
+        *out = 0;
+        return 0;
+    }
+
+    c = (unsigned char) *p++;
+    *out = char_in_set(true_set, c);
+    if (!*out && (false_set[0] | false_set[1] | false_set[2] | false_set[3]) && !char_in_set(false_set, c))
+        return 1;
+
+    while (p < end) {
+        if (!is_field_space(*p))
+            return 1;
+        p++;
+    }
+
+    return 0;
+}
+
+static inline int parse_bool(void *output, char *str, int64_t line_n, int field_len,
+                             const uint64_t *true_set, const uint64_t *false_set) {
+    int v;
+    if (parse_flag(str, field_len, true_set, false_set, &v))
+        return 1;
+    ((uint8_t *) output)[line_n] = (uint8_t) v;
+    return 0;
+}
+
+// Bit-packed variant: row i is bit (i % 8) of byte i / 8 (numpy's bitorder='little').
+static inline int parse_bool_packed(void *output, char *str, int64_t line_n, int field_len,
+                                    const uint64_t *true_set, const uint64_t *false_set) {
+    int v;
+    if (parse_flag(str, field_len, true_set, false_set, &v))
+        return 1;
+    ((uint8_t *) output)[line_n >> 3] |= (uint8_t) (v << (line_n & 7));
+    return 0;
+}
+
+#define DT_YEAR 0
+#define DT_MONTH 1
+#define DT_DAY 2
+#define DT_HOUR 3
+#define DT_MINUTE 4
+#define DT_SECOND 5
+#define DT_FRAC 6
+
+#define DT_MAX_LAYOUT 32
+#define DT_NAT INT64_MIN
+
+/*
+ * A compiled date/time layout such as "YYYYMMDD" or "HH:MM:SS.ffffff". The layout is checked 8
+ * bytes at a time: within each little-endian word, bytes set in digit_mask must be ASCII digits
+ * and bytes set in lit_mask must equal the matching byte of lit.
+ */
+typedef struct {
+    uint64_t lit[DT_MAX_LAYOUT / 8];
+    uint64_t lit_mask[DT_MAX_LAYOUT / 8];
+    uint64_t digit_mask[DT_MAX_LAYOUT / 8];
+    int len;
+    // Offset of each DT_* component in the layout, or -1 if the layout doesn't have it
+    int off[7];
+    int frac_digits;
+    // Output unit as a power of ten of seconds (0 = s, 6 = us, 9 = ns), or -1 for days
+    int unit;
+} DateLayout;
+
+static inline int swar_matches_layout(uint64_t v, uint64_t lit, uint64_t lit_mask, uint64_t digit_mask) {
+    uint64_t t = (v & 0xF0F0F0F0F0F0F0F0ULL) | (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4);
+    return (((t ^ 0x3333333333333333ULL) & digit_mask) | ((v ^ lit) & lit_mask)) == 0;
+}
+
+static inline int matches_layout(const char *p, const DateLayout *layout) {
+    int i = 0;
+#if LP_SWAR
+    for (; i + 8 <= layout->len; i += 8) {
+        if (!swar_matches_layout(swar_load8(p + i), layout->lit[i >> 3], layout->lit_mask[i >> 3],
+                                 layout->digit_mask[i >> 3]))
+            return 0;
+    }
+#endif
+    for (; i < layout->len; i++) {
+        int shift = (i & 7) * 8;
+        unsigned char c = (unsigned char) p[i];
+        if ((layout->digit_mask[i >> 3] >> shift) & 0xFF) {
+            if (c < '0' || c > '9')
+                return 0;
+        } else if ((layout->lit_mask[i >> 3] >> shift) & 0xFF) {
+            if (c != (unsigned char) (layout->lit[i >> 3] >> shift))
+                return 0;
+        }
+    }
+    return 1;
+}
+
+// Only call on characters that have already been checked to be digits.
+static inline int digits2(const char *p) {
+    return (p[0] - '0') * 10 + (p[1] - '0');
 }
 
-inline int parse_i32(void *output, char *str, int64_t line_n, int field_len) {
-    MAKE_PARSER(int32_t, strtol(str, &endptr, 10), output, str, line_n, field_len)
+// Days since 1970-01-01 in the proleptic Gregorian calendar (Howard Hinnant's days_from_civil).
+static inline int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    int64_t era;
+    unsigned yoe, doy, doe;
+    y -= m <= 2;
+    era = (y >= 0 ? y : y - 399) / 400;
+    yoe = (unsigned) (y - era * 400);
+    doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t) doe - 719468;
 }
 
-inline int parse_i16(void *output, char *str, int64_t line_n, int field_len) {
-    MAKE_PARSER(int16_t, strtol(str, &endptr, 10), output, str, line_n, field_len)
+static inline unsigned days_in_month(int64_t y, unsigned m) {
+    static const unsigned char DAYS[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (m == 2 && (y % 4 == 0 && (y % 100 != 0 || y % 400 == 0)))
+        return 29;
+    return DAYS[m - 1];
+}
+
+/*
+ * Parses a date/time in the given layout into a datetime64 (or timedelta64 for time-only layouts)
+ * count of layout->unit. The layout may be preceded by spaces; anything after it must be blank.
+ * A blank field is NaT.
+ */
+static inline int parse_datetime(void *output, char *str, int64_t line_n, int field_len,
+                                 const DateLayout *layout) {
+    const char *p = str;
+    const char *end = str + field_len;
+    const int *off = layout->off;
+    int64_t value = 0, days = 0;
+    int secs = 0;
+
+    while (p < end && *p == ' ')
+        p++;
+
+    if (p == end || *p == 0) {
+        ((int64_t *) output)[line_n] = DT_NAT;
+        return 0;
+    }
+
+    if (end - p < layout->len || !matches_layout(p, layout))
+        return 1;
+
+    if (off[DT_YEAR] >= 0) {
+        int64_t y;
+        unsigned m, d;
+#if LP_SWAR
+        if (off[DT_MONTH] == off[DT_YEAR] + 4 && off[DT_DAY] == off[DT_YEAR] + 6) {
+            // Contiguous YYYYMMDD: one 8 digit conversion
+            uint32_t ymd = swar_parse_8digits(swar_load8(p + off[DT_YEAR]));
+            y = ymd / 10000;
+            m = (ymd / 100) % 100;
+            d = ymd % 100;
+        } else
+#endif
+        {
+            y = digits2(p + off[DT_YEAR]) * 100 + digits2(p + off[DT_YEAR] + 2);
+            m = (unsigned) digits2(p + off[DT_MONTH]);
+            d = (unsigned) digits2(p + off[DT_DAY]);
+        }
+        if (m < 1 || m > 12 || d < 1 || d > days_in_month(y, m))
+            return 1;
+        days = days_from_civil(y, m, d);
+    }
+
+    if (off[DT_HOUR] >= 0) {
+        int h = digits2(p + off[DT_HOUR]);
+        int mi = off[DT_MINUTE] >= 0 ? digits2(p + off[DT_MINUTE]) : 0;
+        int se = off[DT_SECOND] >= 0 ? digits2(p + off[DT_SECOND]) : 0;
+        if (h > 23 || mi > 59 || se > 59)
+            return 1;
+        secs = h * 3600 + mi * 60 + se;
+    }
+
+    if (layout->unit < 0) {
+        value = days;
+    } else {
+        // Out of range for an int64 count of the unit (e.g. after 2262-04-11 in ns) is an error,
+        // like an integer that doesn't fit its type; so is the one value that would read as NaT.
+        int64_t scale = (int64_t) POW10_U64[layout->unit];
+        int64_t whole = days * 86400 + secs, frac = 0;
+        if (off[DT_FRAC] >= 0) {
+            const char *f = p + off[DT_FRAC];
+            int i;
+            for (i = 0; i < layout->frac_digits; i++)
+                frac = frac * 10 + (f[i] - '0');
+            frac *= (int64_t) POW10_U64[layout->unit - layout->frac_digits];
+        }
+        // Before 1970 the fraction is taken off the next second up, so that the earliest times
+        // don't overflow before it is added
+        if (whole < 0 && frac > 0) {
+            whole += 1;
+            frac -= scale;
+        }
+        if (__builtin_mul_overflow(whole, scale, &value) ||
+                __builtin_add_overflow(value, frac, &value) || value == DT_NAT)
+            return 1;
+    }
+
+    p += layout->len;
+    while (p < end) {
+        if (!is_field_space(*p))
+            return 1;
+        p++;
+    }
+
+    ((int64_t *) output)[line_n] = value;
+    return 0;
+}
+
+// Non-zero if the field is nothing but spaces, checked 8 bytes at a time.
+static inline int is_blank(const char *str, int field_len) {
+    const char *p = str;
+    const char *end = str + field_len;
+#if LP_SWAR
+    while (end - p >= 8) {
+        if (swar_load8(p) != 0x2020202020202020ULL)
+            return 0;
+        p += 8;
+    }
+#endif
+    while (p < end) {
+        if (*p != ' ')
+            return 0;
+        p++;
+    }
+    return 1;
+}
+
+// String and Bytes fields with strings='S': row line_n of an np.dtype('S<field_len>') array.
+static inline int parse_fixed_bytes(void *output, const char *str, int64_t line_n, int field_len) {
+    memcpy((char *) output + line_n * field_len, str, field_len);
+    return 0;
+}
+
+
+#define STRIP_LEFT 1
+#define STRIP_RIGHT 2
+
+// The index of the lowest non-zero byte of a non-zero little-endian word.
+static inline int swar_first_set_byte(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v) >> 3;
+#else
+    int n = 0;
+    while ((v & 0xFF) == 0) {
+        v >>= 8;
+        n++;
+    }
+    return n;
+#endif
+}
+
+// The index of the highest non-zero byte of a non-zero little-endian word.
+static inline int swar_last_set_byte(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 7 - (__builtin_clzll(v) >> 3);
+#else
+    int n = 7;
+    while ((v >> 56) == 0) {
+        v <<= 8;
+        n--;
+    }
+    return n;
+#endif
+}
+
+// The number of spaces at the start of the `len` bytes at str. Spaces are found 8 bytes at a
+// time: XORing a word with eight spaces leaves zero bytes exactly where the spaces were.
+static inline int leading_spaces(const char *str, int len) {
+    int n = 0;
+#if LP_SWAR
+    while (len - n >= 8) {
+        uint64_t diff = swar_load8(str + n) ^ 0x2020202020202020ULL;
+        if (diff != 0)
+            return n + swar_first_set_byte(diff);
+        n += 8;
+    }
+#endif
+    while (n < len && str[n] == ' ')
+        n++;
+    return n;
+}
+
+// The number of spaces at the end of the `len` bytes at str, like leading_spaces.
+static inline int trailing_spaces(const char *str, int len) {
+    int n = 0;
+#if LP_SWAR
+    while (len - n >= 8) {
+        uint64_t diff = swar_load8(str + len - n - 8) ^ 0x2020202020202020ULL;
+        if (diff != 0)
+            return n + 7 - swar_last_set_byte(diff);
+        n += 8;
+    }
+#endif
+    while (n < len && str[len - n - 1] == ' ')
+        n++;
+    return n;
+}
+
+// Narrows the field [*str, *str + *len) to leave out its leading spaces (if strip has STRIP_LEFT)
+// and/or its trailing spaces (STRIP_RIGHT).
+static inline void strip_spaces(const char **str, int *len, int strip) {
+    if (strip & STRIP_LEFT) {
+        int n = leading_spaces(*str, *len);
+        *str += n;
+        *len -= n;
+    }
+    if (strip & STRIP_RIGHT)
+        *len -= trailing_spaces(*str, *len);
+}
+
+// Like parse_fixed_bytes, but copies the `len` bytes at str and zero pads the rest of the row.
+static inline int parse_fixed_span(void *output, const char *str, int len, int64_t line_n, int field_len) {
+    char *out = (char *) output + line_n * field_len;
+    memcpy(out, str, len);
+    memset(out + len, 0, field_len - len);
+    return 0;
+}
+
+// Like parse_ucs4, but decodes the `len` bytes at str (part of a field of field_len bytes).
+static inline int parse_ucs4_span(void *output, const char *str, int len, int64_t line_n, int field_len) {
+    static const uint32_t utf8_min[4] = {0, 0x80, 0x800, 0x10000};
+    uint32_t *out = (uint32_t *) output + line_n * field_len;
+    const unsigned char *p = (const unsigned char *) str, *end = p + len;
+    int n = 0;
+
+    while (p < end) {
+        uint32_t c = *p++;
+        if (c >= 0x80) {
+            int extra = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 0, k = extra;
+            if (extra == 0 || c >= 0xF8 || end - p < extra)
+                return 1;
+            c &= 0x3F >> extra;
+            while (k--) {
+                if ((*p & 0xC0) != 0x80)
+                    return 1;
+                c = (c << 6) | (*p++ & 0x3F);
+            }
+            // Overlong encodings (using more bytes than the code point needs) are invalid too
+            if (c < utf8_min[extra] || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF))
+                return 1;
+        }
+        out[n++] = c;
+    }
+    while (n < field_len)
+        out[n++] = 0;
+    return 0;
 }
 
-inline int parse_i8(void *output, char *str, int64_t line_n, int field_len) {
-    MAKE_PARSER(int8_t, strtol(str, &endptr, 10), output, str, line_n, field_len)
+// String fields with strings='U': decodes the UTF-8 of the field into row line_n of an
+// np.dtype('U<field_len>') array (field_len UCS4 code points, zero padded). Fails on malformed
+// UTF-8, including surrogates and values past U+10FFFF.
+static inline int parse_ucs4(void *output, const char *str, int64_t line_n, int field_len) {
+    return parse_ucs4_span(output, str, field_len, line_n, field_len);
 }
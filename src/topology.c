@@ -0,0 +1,218 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * NUMA topology and thread affinity helpers for parse(..., numa=True) and set_threads. They are
+ * only implemented on Linux, where the topology is read from sysfs; everywhere else numa_nodes
+ * reports no nodes (so parse falls back to the regular parallel path) and pinning does nothing.
+ */
+
+#define MAX_NUMA_NODES 64
+
+#ifdef __linux__
+
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/*
+ * Reads a sysfs id list such as "0-3,8-11" from `path` into ids, returning how many there were
+ * (at most max), or -1 if the file can't be read.
+ */
+static int read_id_list(const char *path, int *ids, int max) {
+    char buf[4096];
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+        return -1;
+    size_t len = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[len] = 0;
+
+    int n = 0;
+    char *p = buf;
+    while (*p >= '0' && *p <= '9') {
+        long lo = strtol(p, &p, 10), hi = lo;
+        if (*p == '-')
+            hi = strtol(p + 1, &p, 10);
+        for (long id = lo; id <= hi && n < max; id++)
+            ids[n++] = (int) id;
+        if (*p == ',')
+            p++;
+    }
+    return n;
+}
+
+/* Stores the ids of the online NUMA nodes in ids (room for MAX_NUMA_NODES) and returns the count. */
+static int numa_nodes(int *ids) {
+    int n = read_id_list("/sys/devices/system/node/online", ids, MAX_NUMA_NODES);
+    return n < 0 ? 0 : n;
+}
+
+/*
+ * Restricts the calling thread to the CPUs of `node`. The previous affinity is stored in *saved,
+ * to be handed to unpin_thread. Returns 0 on success; on failure the affinity is left alone.
+ */
+static int numa_pin(int node, void **saved) {
+    char path[64];
+    int cpus[CPU_SETSIZE];
+    cpu_set_t set;
+    *saved = NULL;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    int n = read_id_list(path, cpus, CPU_SETSIZE);
+    if (n <= 0)
+        return 1;
+
+    cpu_set_t *prev = (cpu_set_t *) malloc(sizeof(cpu_set_t));
+    if (prev == NULL || sched_getaffinity(0, sizeof(cpu_set_t), prev) != 0) {
+        free(prev);
+        return 1;
+    }
+
+    /* CPUs past what a cpu_set_t holds are left out */
+    CPU_ZERO(&set);
+    for (int i = 0; i < n; i++)
+        if (cpus[i] >= 0 && cpus[i] < CPU_SETSIZE)
+            CPU_SET(cpus[i], &set);
+    if (CPU_COUNT(&set) == 0 || sched_setaffinity(0, sizeof(cpu_set_t), &set) != 0) {
+        free(prev);
+        return 1;
+    }
+    *saved = prev;
+    return 0;
+}
+
+/* Restricts the calling thread to one CPU, saving the previous affinity like numa_pin does. */
+static int pin_cpu(int cpu, void **saved) {
+    cpu_set_t set;
+    *saved = NULL;
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return 1;
+
+    cpu_set_t *prev = (cpu_set_t *) malloc(sizeof(cpu_set_t));
+    if (prev == NULL || sched_getaffinity(0, sizeof(cpu_set_t), prev) != 0) {
+        free(prev);
+        return 1;
+    }
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(cpu_set_t), &set) != 0) {
+        free(prev);
+        return 1;
+    }
+    *saved = prev;
+    return 0;
+}
+
+/*
+ * The CPUs set_threads(affinity=...) pins the pool's threads to: thread k of a parallel region
+ * runs on cpus[k % ncpus]. A new table is published with an atomic store, and the old ones are
+ * never freed, since a parse on another thread may still be reading them.
+ */
+typedef struct CpuTable {
+    int ncpus;
+    int cpus[];
+} CpuTable;
+
+static CpuTable *pool_table = NULL;
+
+/* The CPU the calling pool thread is pinned to (-1 if none), and its affinity before that. */
+static __thread int pinned_cpu = -1;
+static __thread cpu_set_t unpinned;
+
+static void set_pool_table(CpuTable *table) {
+    __atomic_store_n(&pool_table, table, __ATOMIC_RELEASE);
+}
+
+/*
+ * Pins the calling thread, thread `thread` of its parallel region, to its CPU in the pool table,
+ * or unpins it if there is no table any more. A thread stays pinned across regions, so this
+ * only makes a system call the first time a thread runs after set_threads. Thread 0 is the
+ * thread that started the region, which is pinned by pin_caller for that region alone.
+ */
+static void pool_pin(int thread) {
+    const CpuTable *table = __atomic_load_n(&pool_table, __ATOMIC_ACQUIRE);
+    int cpu = table == NULL ? -1 : table->cpus[thread % table->ncpus];
+    cpu_set_t set;
+    if (thread == 0 || cpu == pinned_cpu || cpu >= CPU_SETSIZE)
+        return;
+    if (pinned_cpu < 0 && sched_getaffinity(0, sizeof(cpu_set_t), &unpinned) != 0)
+        return;
+
+    if (cpu < 0) {
+        sched_setaffinity(0, sizeof(cpu_set_t), &unpinned);
+    } else {
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        sched_setaffinity(0, sizeof(cpu_set_t), &set);
+    }
+    pinned_cpu = cpu;
+}
+
+/*
+ * Pins the calling thread to the CPU of thread 0 in the pool table, for the parallel region it is
+ * about to start. Returns what to hand to unpin_thread once the region is over.
+ */
+static void *pin_caller(void) {
+    const CpuTable *table = __atomic_load_n(&pool_table, __ATOMIC_ACQUIRE);
+    void *saved = NULL;
+    if (table != NULL)
+        pin_cpu(table->cpus[0], &saved);
+    return saved;
+}
+
+/* Undoes numa_pin, pin_cpu or pin_caller. */
+static void unpin_thread(void *saved) {
+    if (saved != NULL) {
+        sched_setaffinity(0, sizeof(cpu_set_t), (cpu_set_t *) saved);
+        free(saved);
+    }
+}
+
+/* The size of the file at path, or -1 if it can't be opened. */
+static int64_t file_size(const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0)
+        return -1;
+    return (int64_t) st.st_size;
+}
+
+/*
+ * Reads bytes [offset, offset + len) of the file at path into dst. Since dst is written by the
+ * calling thread, its pages end up on that thread's node. Returns 0 on success.
+ */
+static int read_file_range(const char *path, char *dst, int64_t offset, int64_t len) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return 1;
+    while (len > 0) {
+        ssize_t got = pread(fd, dst, (size_t) len, (off_t) offset);
+        if (got <= 0) {
+            close(fd);
+            return 1;
+        }
+        dst += got;
+        offset += got;
+        len -= got;
+    }
+    close(fd);
+    return 0;
+}
+
+#else
+
+static int numa_nodes(int *ids) { return 0; }
+static int numa_pin(int node, void **saved) { *saved = NULL; return 1; }
+static int pin_cpu(int cpu, void **saved) { *saved = NULL; return 1; }
+typedef struct CpuTable { int ncpus; int cpus[]; } CpuTable;
+static void set_pool_table(CpuTable *table) { }
+static void pool_pin(int thread) { }
+static void *pin_caller(void) { return NULL; }
+static void unpin_thread(void *saved) { }
+static int64_t file_size(const char *path) { return -1; }
+static int read_file_range(const char *path, char *dst, int64_t offset, int64_t len) { return 1; }
+
+#endif
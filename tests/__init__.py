@@ -3,6 +3,7 @@ import numpy as np
 import time
 
 INTEGER_TYPES = (lp.Ty.Int64, lp.Ty.Int32, lp.Ty.Int16, lp.Ty.Int8)
+UNSIGNED_TYPES = (lp.Ty.UInt64, lp.Ty.UInt32, lp.Ty.UInt16, lp.Ty.UInt8)
 FLOAT_TYPES = (lp.Ty.Float64, lp.Ty.Float32)
 
 def run_n_tests(n, path, min_nfields, max_nfields, min_nlines, max_nlines):
@@ -36,6 +37,8 @@ class FileGenerator:
         exp_ncols = len(fields)
        
         pr = lp.parse(fields, path)
+        # Compare Categorical fields by their values rather than their codes
+        pr = [p.decode() if isinstance(p, lp.CategoricalArray) else p for p in pr]
         assert len(pr) == exp_ncols
         assert len(pr[0]) == exp_nrows
 
@@ -60,7 +63,8 @@ class FileGenerator:
 class FieldGenerator:
 
     tys = [lp.Ty.Float64, lp.Ty.Float32, lp.Ty.Int64, lp.Ty.Int32, lp.Ty.Int16, lp.Ty.Int8,
-           lp.Ty.String, lp.Ty.Bytes]
+           lp.Ty.String, lp.Ty.Bytes, lp.Ty.Decimal, lp.Ty.UInt64, lp.Ty.UInt32, lp.Ty.UInt16,
+           lp.Ty.UInt8, lp.Ty.Categorical]
 
     def __init__(self):
         self.rng = np.random.RandomState(int(time.time()))
@@ -69,6 +73,8 @@ class FieldGenerator:
         index = self.rng.randint(len(FieldGenerator.tys))
         ty = FieldGenerator.tys[index]
         length = self.make_len(ty)
+        if ty == lp.Ty.Decimal:
+            return lp.Field(ty, length, scale=self.rng.randint(length - 2))
         return lp.Field(ty, length)
 
     def make_len(self, ty):
@@ -82,6 +88,16 @@ class FieldGenerator:
             return self.rng.randint(7) + 1
         elif ty == lp.Ty.Int64:
             return self.rng.randint(10) + 1
+        elif ty == lp.Ty.UInt8:
+            return self.rng.randint(2) + 1
+        elif ty == lp.Ty.UInt16:
+            return self.rng.randint(4) + 1
+        elif ty == lp.Ty.UInt32:
+            return self.rng.randint(9) + 1
+        elif ty == lp.Ty.UInt64:
+            return self.rng.randint(19) + 1
+        elif ty == lp.Ty.Decimal:
+            return self.rng.randint(16) + 3
         else:
             return self.rng.randint(15) + 5
 class FieldSpoofer:
@@ -97,10 +113,16 @@ class FieldSpoofer:
             value, s = self.spoof_float(field.len)
         elif field.ty in INTEGER_TYPES:
             value, s = self.spoof_int(field.len)
+        elif field.ty in UNSIGNED_TYPES:
+            value, s = self.spoof_uint(field.len)
         elif field.ty  == lp.Ty.String:
             value, s = self.spoof_string(field.len)
         elif field.ty == lp.Ty.Bytes:
             value, s = self.spoof_bytes(field.len)
+        elif field.ty == lp.Ty.Decimal:
+            value, s = self.spoof_decimal(field.len, field.scale)
+        elif field.ty == lp.Ty.Categorical:
+            value, s = self.spoof_categorical(field.len)
         else:
             raise Exception("This should be unreachable")
 
@@ -134,10 +156,485 @@ class FieldSpoofer:
         s = str(value)
         return value, s
 
+    def spoof_uint(self, len: int):
+        s = "".join(map(str, self.rng.randint(0, 10, len)))
+        return int(s), s
+
+    def spoof_decimal(self, len: int, scale: int):
+        # Leave room for the sign and the decimal point
+        ndigits = self.rng.randint(scale, len - 1)
+        digits = "".join(map(str, self.rng.randint(0, 10, ndigits))).rjust(scale + 1, '0')
+        sign = "-" if self.rng.randint(2) else ""
+        value = int(sign + digits)
+        point = max(ndigits, scale + 1) - scale
+        s = sign + digits[:point] + "." + digits[point:]
+        return value, s
+
     def spoof_bytes(self, len: int):
         v = bytes(self.rng.randint(65, 126, len, dtype=np.int8))
         return v, v.decode('utf-8')
 
+    def spoof_categorical(self, len: int):
+        # One of a handful of labels, so that values repeat
+        s = chr(65 + self.rng.randint(4)) * len
+        return s.encode('utf-8'), s
+
     def spoof_string(self, len: int):
         s = str(self.spoof_bytes(len)[0].decode('utf-8'))
         return s, s
+
+def check_arrow(path, nlines):
+    """
+    Parses a file with result="arrow" and checks that pyarrow reads the same values through the
+    Arrow PyCapsule interface as parse returns. Skipped if pyarrow isn't installed.
+    """
+    try:
+        import pyarrow as pa
+    except ImportError:
+        return
+    fields = [lp.Field(lp.Ty.Int32, 6), lp.Field(lp.Ty.Float64, 10), lp.Field(lp.Ty.String, 5),
+              lp.Field(lp.Ty.Bytes, 4), lp.Field(lp.Ty.Bool, 1, packed=True),
+              lp.Field(lp.Ty.Int64, 4, nulls="mask"), lp.Field(lp.Ty.Decimal, 7, scale=2)]
+    with open(path, "w") as file:
+        for i in range(nlines):
+            missing = "    " if i % 5 == 0 else f"{i % 1000:4d}"
+            file.write(f"{i:6d}{i * 0.25:10.2f}s{i % 10000:04d}b{i % 1000:03d}{'TF'[i % 3 == 0]}"
+                       f"{missing}{i * 0.01:7.2f}\n")
+
+    expected = lp.parse(fields, path)
+    table = pa.table(lp.parse(fields, path, result="arrow"))
+    assert table.num_rows == nlines
+    columns = [table.column(name).to_pylist() for name in table.column_names]
+    assert columns[0] == expected[0].tolist()
+    assert columns[1] == expected[1].tolist()
+    assert columns[2] == expected[2]
+    assert columns[3] == expected[3]
+    assert columns[4] == np.unpackbits(expected[4], bitorder="little")[:nlines].astype(bool).tolist()
+    assert columns[5] == [None if m else v for v, m in zip(expected[5].data.tolist(), expected[5].mask)]
+    assert [int(v.scaleb(2)) for v in columns[6]] == expected[6].tolist()
+
+    # A single column goes through __arrow_c_array__ too
+    first = lp.parse([fields[0], lp.Field(lp.Ty.Phantom, 31)], path, result="arrow")
+    assert pa.array(first.column("f0")).to_pylist() == columns[0]
+
+def check_strip(path, nlines):
+    """
+    Checks every strip mode of String, Bytes and Categorical fields against Python's own strip,
+    for object, "S" and "U" outputs.
+    """
+    rng = np.random.RandomState(int(time.time()))
+    widths = (3, 9, 12)
+    values = []
+    with open(path, "wb") as file:
+        for i in range(nlines):
+            row = []
+            for width in widths:
+                core = "".join(rng.choice(list("ab é"), rng.randint(width + 1)))
+                core = core.encode("utf-8")[:width].decode("utf-8", "ignore")
+                padding = rng.randint(width - len(core.encode("utf-8")) + 1)
+                row.append((" " * padding + core).encode("utf-8").ljust(width))
+            values.append(row)
+            file.write(b"".join(row) + b"\n")
+
+    strip = {None: lambda b: b, "left": lambda b: b.lstrip(b" "),
+             "right": lambda b: b.rstrip(b" "), "both": lambda b: b.strip(b" ")}
+    for mode, fn in strip.items():
+        fields = [lp.Field(lp.Ty.String, 3, strip=mode), lp.Field(lp.Ty.Bytes, 9, strip=mode),
+                  lp.Field(lp.Ty.Categorical, 12, strip=mode)]
+        expected = [[fn(row[k]) for row in values] for k in range(len(widths))]
+        for strings in ("object", "S", "U"):
+            pr = lp.parse(fields, path, strings=strings)
+            if strings == "object":
+                assert pr[0] == [e.decode("utf-8") for e in expected[0]]
+                assert pr[1] == expected[1]
+            elif strings == "S":
+                assert pr[0].tolist() == expected[0]
+                assert pr[1].tolist() == expected[1]
+            else:
+                assert pr[0].tolist() == [e.decode("utf-8") for e in expected[0]]
+                assert pr[1].tolist() == expected[1]
+            assert pr[2].decode().tolist() == expected[2]
+
+def check_out_reuse(path):
+    """
+    Parses files of different lengths into the same outputs with `out=`, both as ParseBuffers and
+    as a dict of arrays, and checks that packed Bools and masks hold nothing from earlier parses.
+    """
+    fields = [lp.Field(lp.Ty.Int32, 5), lp.Field(lp.Ty.Bool, 1, packed=True),
+              lp.Field(lp.Ty.Int64, 3, nulls="mask")]
+
+    def write(nlines, offset):
+        with open(path, "w") as file:
+            for i in range(offset, offset + nlines):
+                missing = "   " if i % 4 == 0 else f"{i % 1000:3d}"
+                file.write(f"{i:5d}{'TF'[i % 3 == 0]}{missing}\n")
+
+    buffers = lp.ParseBuffers(fields)
+    for nlines, offset in ((100, 0), (13, 1), (1000, 2), (5, 3), (64, 4)):
+        write(nlines, offset)
+        expected = lp.parse(fields, path)
+        assert lp.parse(fields, path, out=buffers) == nlines
+        columns = buffers.columns()
+        assert (columns[0] == expected[0]).all()
+        assert (columns[1] == expected[1]).all()
+        assert (columns[2].mask == expected[2].mask).all()
+        assert (columns[2].filled(0) == expected[2].filled(0)).all()
+
+    # With a dict of arrays only the parsed rows are written
+    bits = np.full(200, 0xFF, dtype=np.uint8)
+    masked = np.ma.MaskedArray(np.zeros(1600, dtype=np.int64), mask=np.ones(1600, dtype=bool))
+    for nlines, offset in ((1000, 0), (13, 1)):
+        write(nlines, offset)
+        expected = lp.parse(fields, path)
+        out = {0: np.zeros(1600, dtype=np.int32), 1: bits, 2: masked}
+        assert lp.parse(fields, path, out=out) == nlines
+        unpacked = np.unpackbits(bits, bitorder="little")
+        assert (unpacked[:nlines] == np.unpackbits(expected[1], bitorder="little")[:nlines]).all()
+        assert (unpacked[nlines:] == 1).all()
+        assert (masked.mask[:nlines] == expected[2].mask).all() and masked.mask[nlines:].all()
+        bits[:] = 0xFF
+        masked.mask[:] = True
+
+def check_table_builder(path, nfiles, max_nlines):
+    """
+    Appends random files to a TableBuilder, along with bad buffers that must leave it as it was,
+    and checks that `finish` returns what parsing all of the files at once does.
+    """
+    fg = FileGenerator()
+    rng = np.random.RandomState(int(time.time()))
+    fields = [fg.field_gen.next() for _ in range(rng.randint(1, 8))]
+    for strings in ("object", "S", "U"):
+        builder = lp.TableBuilder(fields, strings=strings)
+        contents = b""
+        for i in range(nfiles):
+            values = []
+            data = b"".join(fg.make_line(fields, values) for _ in range(rng.randint(1, max_nlines + 1)))
+            with open(path, "wb") as file:
+                file.write(data)
+            assert builder.append_file(path) == len(values)
+            contents += data
+
+            # The file with its last line cut short, followed by the whole file again: the lines
+            # before the short one must be rolled back
+            try:
+                builder.append_buffer(data[:-2] + b"\n" + data)
+                assert False
+            except lp.LineParsingError:
+                pass
+            assert len(builder) == contents.count(b"\n")
+
+        with open(path, "wb") as file:
+            file.write(contents)
+        expected = lp.parse(fields, path, strings=strings)
+        columns = builder.finish()
+        assert len(builder) == 0
+        for e, c in zip(expected, columns):
+            if isinstance(e, lp.CategoricalArray):
+                assert (e.decode() == c.decode()).all()
+            elif isinstance(e, list):
+                assert e == c
+            else:
+                assert (np.asarray(e) == np.asarray(c)).all()
+
+def check_records_threads(path, threads):
+    """
+    Checks that result="records" gives the same records with `threads` threads as with one, and
+    the same values as the columns from parse. The file is large enough to be split between the
+    threads, and has a run of blank lines as long as a line in the middle, which isn't a record.
+    """
+    fields = [lp.Field(lp.Ty.Float64, 10), lp.Field(lp.Ty.Int32, 6), lp.Field(lp.Ty.Phantom, 2),
+              lp.Field(lp.Ty.Bytes, 4), lp.Field(lp.Ty.Bool, 1, packed=True),
+              lp.Field(lp.Ty.Categorical, 3), lp.Field(lp.Ty.Int16, 3, nulls="fill", fill_value=-1)]
+    nlines = threads * (1 << 20) // 30 + 7
+    with open(path, "w") as file:
+        for i in range(nlines):
+            missing = "   " if i % 4 == 0 else f"{i % 100:3d}"
+            file.write(f"{i * 0.5:10.1f}{i % 100000:6d}xxb{i % 100:03d}{'TF'[i % 3 == 0]}"
+                       f"{'abc' if i % 2 else 'xyz'}{missing}\n")
+            if i == nlines // 2:
+                file.write("\n" * 30)
+
+    one = lp.parse(fields, path, result="records", threads=1)
+    many = lp.parse(fields, path, result="records", threads=threads)
+    assert len(one) == nlines and one.dtype == many.dtype
+    assert (one == many).all()
+
+    columns = lp.parse(fields, path, threads=threads, strings="S")
+    assert (one["f0"] == columns[0]).all() and (one["f1"] == columns[1]).all()
+    assert (one["f2"] == columns[2]).all() and (one["f5"] == columns[5]).all()
+    assert (one["f3"] == np.unpackbits(columns[3], bitorder="little")[:nlines].astype(bool)).all()
+    assert (one["f4"] == columns[4].decode()).all()
+
+def same_columns(expected, columns):
+    # Whether two outputs of parse hold the same values.
+    if len(expected) != len(columns):
+        return False
+    for e, c in zip(expected, columns):
+        if isinstance(e, lp.CategoricalArray):
+            e, c = e.decode(), c.decode()
+        if isinstance(e, np.ma.MaskedArray):
+            if not (e.mask == c.mask).all():
+                return False
+            e, c = e.filled(0), c.filled(0)
+        if isinstance(e, list):
+            if e != c:
+                return False
+        elif len(e) != len(c) or not (np.asarray(e) == np.asarray(c)).all():
+            return False
+    return True
+
+def check_threads(path, threads):
+    """
+    Parses a file with runs of blank lines in it on one thread and on `threads` threads, which
+    must give the same rows: the blank lines end on the stride of the other lines, but mustn't be
+    taken for lines. The file is large enough to be split between the threads.
+    """
+    fg = FileGenerator()
+    rng = np.random.RandomState(int(time.time()))
+    fields = [fg.field_gen.next() for _ in range(rng.randint(1, 6))]
+    line_len = sum(field.len for field in fields)
+    values = []
+    block = b"".join(fg.make_line(fields, values) for _ in range(1000))
+    with open(path, "wb") as file:
+        while file.tell() < threads * (1 << 20):
+            file.write(block)
+            # A run of blank lines as long as a line and its terminator, or several of them
+            file.write(b"\n" * ((line_len + 1) * rng.randint(1, 3)))
+        file.write(block)
+
+    expected = lp.parse(fields, path, threads=1)
+    assert len(expected[0]) % 1000 == 0
+    assert same_columns(expected, lp.parse(fields, path, threads=threads))
+    assert same_columns(expected, lp.parse(fields, path, threads=threads, split="columns"))
+    assert same_columns(expected, lp.parse_many(fields, [path], threads=threads))
+
+INTEGER_DTYPES = {lp.Ty.Int64: np.int64, lp.Ty.Int32: np.int32, lp.Ty.Int16: np.int16,
+                  lp.Ty.Int8: np.int8, lp.Ty.UInt64: np.uint64, lp.Ty.UInt32: np.uint32,
+                  lp.Ty.UInt16: np.uint16, lp.Ty.UInt8: np.uint8}
+
+def write_lines(path, lines):
+    # Writes `lines` (bytes) to `path`, one per line, and returns the path.
+    with open(path, "wb") as file:
+        file.write(b"".join(line + b"\n" for line in lines))
+    return path
+
+def check_int_ranges(path):
+    """
+    Checks that every integer type parses the ends of its range, and that one past either end is
+    a LineParsingError rather than a wrapped value.
+    """
+    for ty, dtype in INTEGER_DTYPES.items():
+        info = np.iinfo(dtype)
+        width = len(str(info.min)) + len(str(info.max))
+        field = lp.Field(ty, width)
+        ends = [int(info.min), int(info.max)]
+        pr = lp.parse([field], write_lines(path, [str(v).rjust(width).encode() for v in ends]))
+        assert pr[0].dtype == dtype and pr[0].tolist() == ends
+        for v in (ends[0] - 1, ends[1] + 1):
+            try:
+                lp.parse([field], write_lines(path, [b"0".rjust(width), str(v).rjust(width).encode()]))
+                assert False
+            except lp.LineParsingError as e:
+                assert e.line_n == 1 and e.field_index == 0
+
+def check_datetimes(path, nlines):
+    """
+    Parses random dates and times in several layouts and compares them with numpy's own parsing.
+    Blank fields must be NaT, and invalid or out of range values must be errors.
+    """
+    rng = np.random.RandomState(int(time.time()))
+    # Seconds since 1970 up to 2200, which every unit can hold
+    seconds = rng.randint(-(1 << 31), 7258118400, nlines, dtype=np.int64)
+    stamps = seconds.astype("datetime64[s]").astype("datetime64[ns]") + \
+        rng.randint(0, 10 ** 9, nlines).astype("timedelta64[ns]")
+    iso = np.datetime_as_string(stamps, unit="ns")
+    layouts = [
+        ("YYYYMMDD", lambda s: s[0:4] + s[5:7] + s[8:10], "datetime64[D]"),
+        ("YYYY-MM-DD HH:MM:SS", lambda s: s[:10] + " " + s[11:19], "datetime64[s]"),
+        ("YYYYMMDDHHMMSS.ffffff", lambda s: (s[0:4] + s[5:7] + s[8:10] + s[11:13] + s[14:16] +
+                                             s[17:19] + s[19:26]), "datetime64[us]"),
+        ("YYYY-MM-DDTHH:MM:SS.fffffffff", lambda s: s, "datetime64[ns]"),
+        ("HH:MM:SS", lambda s: s[11:19], "timedelta64[s]"),
+    ]
+    for layout, fmt, dtype in layouts:
+        width = len(layout) + 2
+        field = lp.Field(lp.Ty.DateTime, width, layout=layout)
+        lines = [(b"" if i % 7 == 0 else fmt(s).encode()).rjust(width) for i, s in enumerate(iso)]
+        [pr] = lp.parse([field], write_lines(path, lines))
+        assert pr.dtype == np.dtype(dtype)
+        if dtype.startswith("datetime64"):
+            expected = stamps.astype(dtype)
+        else:
+            expected = (stamps - stamps.astype("datetime64[D]")).astype(dtype)
+        assert np.isnat(pr[::7]).all()
+        blank = np.arange(nlines) % 7 == 0
+        assert (pr[~blank] == expected[~blank]).all()
+
+    # Bad months and days, and times past what nanoseconds can hold
+    layout = "YYYY-MM-DD HH:MM:SS.fffffffff"
+    field = lp.Field(lp.Ty.DateTime, len(layout), layout=layout)
+    ends = [b"1677-09-21 00:12:43.145224193", b"2262-04-11 23:47:16.854775807"]
+    [pr] = lp.parse([field], write_lines(path, ends))
+    assert pr.view(np.int64).tolist() == [-(1 << 63) + 1, (1 << 63) - 1]
+    for bad in (b"2021-02-29 00:00:00.000000000", b"2021-13-01 00:00:00.000000000",
+                b"2021-01-01 24:00:00.000000000", b"2262-04-11 23:47:16.854775808",
+                b"1677-09-21 00:12:43.145224192", b"2300-01-01 00:00:00.000000001"):
+        try:
+            lp.parse([field], write_lines(path, ends + [bad]))
+            assert False
+        except lp.LineParsingError as e:
+            assert e.line_n == 2
+
+def check_nulls(path, nlines):
+    """
+    Checks nulls="fill" and nulls="mask" on a file with random blank fields: blank fields get the
+    fill value (or the type's default one), or are masked, and the rest parse as usual.
+    """
+    rng = np.random.RandomState(int(time.time()))
+    blank = rng.randint(4, size=(nlines, 4)) == 0
+    values = rng.randint(-99, 100, size=(nlines, 4))
+    lines = [b"".join(b"    " if blank[i, k] else b"%4d" % values[i, k] for k in range(4))
+             for i in range(nlines)]
+    write_lines(path, lines)
+
+    fields = [lp.Field(lp.Ty.Int32, 4, nulls="fill"), lp.Field(lp.Ty.Float64, 4, nulls="fill"),
+              lp.Field(lp.Ty.Int16, 4, nulls="fill", fill_value=-1),
+              lp.Field(lp.Ty.Int64, 4, nulls="mask")]
+    fills = [np.iinfo(np.int32).min, np.nan, -1]
+    pr = lp.parse(fields, path)
+    for k in range(3):
+        expected = np.where(blank[:, k], fills[k], values[:, k])
+        assert np.array_equal(pr[k], expected.astype(pr[k].dtype), equal_nan=True)
+    assert isinstance(pr[3], np.ma.MaskedArray)
+    assert (pr[3].mask == blank[:, 3]).all()
+    assert (pr[3].data[~blank[:, 3]] == values[~blank[:, 3], 3]).all()
+
+    # Without a nulls mode blank fields are 0
+    [pr] = lp.parse([lp.Field(lp.Ty.Int32, 4), lp.Field(lp.Ty.Phantom, 12)], path)
+    assert (pr == np.where(blank[:, 0], 0, values[:, 0])).all()
+
+def check_na_values(path, nlines):
+    """
+    Checks that fields equal to one of their na_values are handled like blank fields: filled by
+    default, or masked with nulls="mask", while other values (and near misses) are kept.
+    """
+    rng = np.random.RandomState(int(time.time()))
+    floats = rng.choice([-999.99, 9999.0, 1.5, -999.98, 0.25], nlines)
+    ints = rng.choice([-99, 999, 5, 998], nlines)
+    write_lines(path, [b"%8.2f%4d" % (f, i) for f, i in zip(floats, ints)])
+
+    fields = [lp.Field(lp.Ty.Float32, 8, na_values=[-999.99, 9999]),
+              lp.Field(lp.Ty.Int16, 4, nulls="mask", na_values=[-99, 999])]
+    pr = lp.parse(fields, path)
+    na = (floats == -999.99) | (floats == 9999.0)
+    assert np.isnan(pr[0][na]).all()
+    assert (pr[0][~na] == floats[~na].astype(np.float32)).all()
+    na = (ints == -99) | (ints == 999)
+    assert (pr[1].mask == na).all() and (pr[1].data[~na] == ints[~na]).all()
+
+    # Decimal codes are compared exactly, after scaling
+    fields = [lp.Field(lp.Ty.Decimal, 8, scale=2, na_values=[-999.99], fill_value=0),
+              lp.Field(lp.Ty.Phantom, 4)]
+    [pr] = lp.parse(fields, path)
+    assert (pr == np.where(floats == -999.99, 0, np.round(floats * 100))).all()
+
+def concat_batches(batches):
+    # The batches of iter_batches joined into one list of values per field. They are converted as
+    # they come, since the arrays of a batch are reused.
+    columns = None
+    for batch in batches:
+        if columns is None:
+            columns = [[] for _ in batch]
+        for column, c in zip(columns, batch):
+            column.extend(c if isinstance(c, list) else np.array(c).tolist())
+    return columns
+
+def check_batches(path, nlines):
+    """
+    Checks that iter_batches gives the same rows as parse, in batches of several sizes, on a file
+    with CRLF terminators and blank lines.
+    """
+    fg = FileGenerator()
+    rng = np.random.RandomState(int(time.time()))
+    fields = [fg.field_gen.next() for _ in range(rng.randint(1, 6))]
+    values = []
+    with open(path, "wb") as file:
+        for i in range(nlines):
+            file.write(fg.make_line(fields, values)[:-1] + b"\r\n")
+            if rng.randint(20) == 0:
+                file.write(b"\r\n" * rng.randint(1, 4))
+
+    expected = [c.decode() if isinstance(c, lp.CategoricalArray) else c
+                for c in lp.parse(fields, path)]
+    expected = [c if isinstance(c, list) else np.asarray(c).tolist() for c in expected]
+    assert len(expected[0]) == nlines
+    for batch_rows in (1, 7, 64, nlines + 1):
+        batches = lp.iter_batches(fields, path, batch_rows=batch_rows, depth=rng.randint(1, 4))
+        batches = ([c.decode() if isinstance(c, lp.CategoricalArray) else c for c in batch]
+                   for batch in batches)
+        assert concat_batches(batches) == expected
+
+def check_async(path, nlines):
+    """
+    Checks parse_async and iter_batches_async against parse, and that breaking out of
+    `async for` early stops the iterator's threads once it has been collected.
+    """
+    import asyncio
+    import gc
+    import threading
+    fields = [lp.Field(lp.Ty.Int32, 6), lp.Field(lp.Ty.Float64, 8)]
+    write_lines(path, [b"%6d%8.2f" % (i, i / 4) for i in range(nlines)])
+    expected = [c.tolist() for c in lp.parse(fields, path)]
+
+    def busy_helpers():
+        helpers = [t for t in threading.enumerate() if t.name == "lineparser-helper"]
+        return len(helpers) - lp.helper_pool.idle
+
+    async def run():
+        assert [c.tolist() for c in await lp.parse_async(fields, path)] == expected
+        batches = [[np.array(c) for c in batch]
+                   async for batch in lp.iter_batches_async(fields, path, batch_rows=100)]
+        assert concat_batches(batches) == expected
+
+        for _ in range(3):
+            async for batch in lp.iter_batches_async(fields, path, batch_rows=10, depth=1):
+                break
+        gc.collect()
+        for _ in range(100):
+            if busy_helpers() == 0:
+                break
+            await asyncio.sleep(0.05)
+        assert busy_helpers() == 0
+
+    asyncio.run(run())
+
+def check_open_table(path, nlines):
+    """
+    Checks every column of an open_table Table against parse, and that a file with a blank line in
+    it is rejected by both `records` and `column` rather than read with shifted rows.
+    """
+    fg = FileGenerator()
+    rng = np.random.RandomState(int(time.time()))
+    fields = [fg.field_gen.next() for _ in range(rng.randint(1, 6))]
+    values = []
+    lines = [fg.make_line(fields, values) for _ in range(nlines)]
+    with open(path, "wb") as file:
+        file.write(b"".join(lines))
+
+    expected = lp.parse(fields, path, strings="S")
+    table = lp.open_table(fields, path)
+    assert len(table) == nlines and len(table.records) == nlines
+    for k, e in enumerate(expected):
+        assert same_columns([e], [table.column(f"f{k}")])
+        assert table.column(f"f{k}") is table.column(f"f{k}") or e.dtype.kind == "S"
+
+    if nlines > 1:
+        with open(path, "wb") as file:
+            file.write(b"".join(lines[:nlines // 2]) + b"\n" * len(lines[0]) +
+                       b"".join(lines[nlines // 2:]))
+        for read in (lambda t: t.records, lambda t: t.column("f0")):
+            try:
+                read(lp.open_table(fields, path))
+                assert False
+            except lp.LineParsingError:
+                pass